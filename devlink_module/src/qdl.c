@@ -34,6 +34,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
@@ -55,8 +56,19 @@
 
 #define QDL_CTRL_BUFF_SIZE                            200
 
-static int qdl_socket = QDL_SOCKET_ERROR;
-static int qdl_socket_count = 0;
+#define QDL_INVALID_FAMILY_ID                         0                    /* generic netlink never assigns 0 */
+#define QDL_REGION_READ_BUFF_SIZE                     32768                /* netlink caps dump messages at 32 kB */
+
+/* Netlink session of the calling thread. Descriptors created by a thread share its socket, so
+ * threads never interleave requests and replies on one socket. Socket is bound once and stays
+ * open, with its receive buffer, until the thread exits or calls qdl_close_session(). */
+static pthread_key_t qdl_session_key;
+static pthread_once_t qdl_session_key_once = PTHREAD_ONCE_INIT;
+static bool qdl_session_key_ready = false;
+
+/* Devlink family ID is fixed for the life of the kernel - it is resolved once per process */
+static uint32_t qdl_family_id = QDL_INVALID_FAMILY_ID;
+static pthread_mutex_t qdl_family_id_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /**
  * _qdl_get_ctrl_msg_status
@@ -95,6 +107,235 @@ qdl_status_t _qdl_get_ctrl_msg_status(struct nlmsghdr *msg)
 	return status;
 }
 
+/**
+ * qdl_receive_msg
+ * @dscr: QDL descriptor
+ * @rec_msg_buff: buffer for received message
+ * @rec_msg_size: buffer size
+ *
+ * Receives message.
+ * Returns QDL_SUCCESS if the function succeeds, otherwise an error code.
+ */
+qdl_status_t _qdl_receive_msg(qdl_dscr_t dscr, uint8_t *rec_msg_buff, unsigned int *rec_msg_size)
+{
+	struct msghdr rec_msg;
+	struct iovec iov;
+	qdl_struct *dscr_data = (qdl_struct*)dscr;
+	int return_value = 0;
+
+	/* Validate input parameters */
+	if(dscr == NULL || rec_msg_buff == NULL || rec_msg_size == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	/* Initialize parameters */
+	memset(&rec_msg, 0, sizeof(rec_msg));
+	memset(&iov, 0, sizeof(iov));
+
+	/* Receive message */
+	iov.iov_base = rec_msg_buff;
+	iov.iov_len = *rec_msg_size;
+	rec_msg.msg_name = &dscr_data->socket_addr;
+	rec_msg.msg_namelen = sizeof(dscr_data->socket_addr);
+	rec_msg.msg_iov = &iov;
+	rec_msg.msg_iovlen = 1;
+	rec_msg.msg_control = NULL;
+	rec_msg.msg_controllen = 0;
+	rec_msg.msg_flags = 0;
+	return_value = recvmsg(dscr_data->socket, &rec_msg, 0);
+	if(return_value == -1) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("recvmsg", errno);
+		return QDL_RECEIVE_MSG_ERROR;
+	}
+	*rec_msg_size = return_value;
+
+	/* Buffer is too small */
+	if(rec_msg.msg_flags & MSG_TRUNC) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("msg_flags", MSG_TRUNC);
+		return QDL_RECEIVE_MSG_ERROR;
+	}
+
+	if(rec_msg.msg_namelen != sizeof(struct sockaddr_nl)) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("msg_namelen", rec_msg.msg_namelen);
+		return QDL_RECEIVE_MSG_ERROR;
+	}
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * _qdl_reserve_rec_buff
+ * @dscr: QDL descriptor
+ * @size: required buffer size
+ *
+ * Grows the receive buffer of the descriptor session geometrically, so it can hold at least 'size'
+ * bytes. Content of the buffer is preserved and never zeroed.
+ * Returns QDL_SUCCESS if function succeeds, otherwise error code.
+ */
+qdl_status_t _qdl_reserve_rec_buff(qdl_dscr_t dscr, unsigned int size)
+{
+	qdl_session_struct *session = ((qdl_struct*)dscr)->session;
+	uint8_t *buff = NULL;
+	unsigned int buff_size = session->rec_buff_size;
+
+	if(session->rec_buff != NULL && size <= session->rec_buff_size) {
+		return QDL_SUCCESS;
+	}
+
+	if(buff_size == 0) {
+		buff_size = QDL_REC_BUFF_SIZE;
+	}
+	while(buff_size < size) {
+		buff_size *= 2;
+	}
+
+	buff = realloc(session->rec_buff, buff_size);
+	if(buff == NULL) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("realloc", 0);
+		return QDL_MEMORY_ERROR;
+	}
+	session->rec_buff = buff;
+	session->rec_buff_size = buff_size;
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * _qdl_receive_part
+ * @dscr: QDL descriptor
+ * @offset: offset in the session receive buffer for the received part
+ * @part_size: size of the received part
+ *
+ * Receives one datagram of the reply into the session receive buffer. Size of the datagram is
+ * checked with MSG_PEEK | MSG_TRUNC first and the buffer grows if needed.
+ * Returns QDL_SUCCESS if the function succeeds, otherwise an error code.
+ */
+qdl_status_t _qdl_receive_part(qdl_dscr_t dscr, unsigned int offset, unsigned int *part_size)
+{
+	qdl_struct *dscr_data = (qdl_struct*)dscr;
+	qdl_status_t status = QDL_SUCCESS;
+	ssize_t length = 0;
+
+	length = recv(dscr_data->socket, NULL, 0, MSG_PEEK | MSG_TRUNC);
+	if(length < 0) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("recv", errno);
+		return QDL_RECEIVE_MSG_ERROR;
+	}
+
+	status = _qdl_reserve_rec_buff(dscr, offset + (unsigned int)length);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_reserve_rec_buff", status);
+		return status;
+	}
+
+	*part_size = dscr_data->session->rec_buff_size - offset;
+	status = _qdl_receive_msg(dscr, dscr_data->session->rec_buff + offset, part_size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_msg", status);
+		return status;
+	}
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * _qdl_receive_reply
+ * @dscr: QDL descriptor
+ * @reply: returned address of the received messages
+ * @reply_size: returned size of the received messages
+ *
+ * Receives all parts of the reply up to the control message into the session receive buffer. The
+ * returned buffer is valid until the next receive on the session.
+ * Returns QDL_SUCCESS if the function succeeds, otherwise an error code.
+ */
+qdl_status_t _qdl_receive_reply(qdl_dscr_t dscr, uint8_t **reply, unsigned int *reply_size)
+{
+	qdl_session_struct *session = ((qdl_struct*)dscr)->session;
+	struct nlmsghdr *msg = NULL;
+	uint8_t *part = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+	unsigned int msgs_size = 0;
+	unsigned int part_size = 0;
+
+	while(true) {
+		status = _qdl_receive_part(dscr, msgs_size, &part_size);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_part", status);
+			return status;
+		}
+		part = session->rec_buff + msgs_size;
+		msgs_size += part_size;
+
+		/* Check if we got control message */
+		msg = (struct nlmsghdr*)_qdl_get_next_msg(part, part_size, NULL);
+		while(msg != NULL) {
+			if(_qdl_is_ctrl_msg(msg)) {
+				*reply = session->rec_buff;
+				*reply_size = msgs_size;
+				return _qdl_get_ctrl_msg_status(msg);
+			}
+			msg = (struct nlmsghdr*)_qdl_get_next_msg(part, part_size, (uint8_t*)msg);
+		}
+	}
+}
+
+/**
+ * _qdl_send_request
+ * @dscr: QDL descriptor
+ * @cmd_type: command type of message
+ * @data: optional message data dependent on cmd_type
+ *
+ * Builds request in the session send buffer and sends it, so no memory is allocated per request.
+ * Returns QDL_SUCCESS if the function succeeds, otherwise an error code.
+ */
+qdl_status_t _qdl_send_request(qdl_dscr_t dscr, int cmd_type, void *data)
+{
+	qdl_session_struct *session = ((qdl_struct*)dscr)->session;
+	qdl_status_t status = QDL_SUCCESS;
+	unsigned int msg_size = 0;
+
+	status = qdl_build_msg(dscr, cmd_type, data, (uint8_t*)session->send_buff, sizeof(session->send_buff),
+			       &msg_size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_build_msg", status);
+		return QDL_CREATE_MSG_ERROR;
+	}
+
+	return qdl_send_msg(dscr, (uint8_t*)session->send_buff, msg_size);
+}
+
+/**
+ * _qdl_receive_pooled_reply_msg
+ * @dscr: QDL descriptor
+ * @cmd_type: command type of message
+ * @data: optional data for send message
+ * @reply: returned address of the reply
+ * @reply_size: returned reply size
+ *
+ * Works like qdl_receive_reply_msg() but the reply is stored in the session receive buffer, which
+ * is valid until the next receive on the session.
+ * Returns QDL_SUCCESS if the function succeeds, otherwise an error code.
+ */
+qdl_status_t _qdl_receive_pooled_reply_msg(qdl_dscr_t dscr, int cmd_type, void *data, uint8_t **reply,
+					   unsigned int *reply_size)
+{
+	qdl_status_t status = QDL_SUCCESS;
+
+	status = _qdl_send_request(dscr, cmd_type, data);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_send_request", status);
+		return status;
+	}
+
+	status = _qdl_receive_reply(dscr, reply, reply_size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_reply", status);
+		*reply_size = 0;
+	}
+
+	return status;
+}
+
 /**
  * _qdl_get_bus_name
  * @dscr: QDL descriptor
@@ -113,6 +354,28 @@ char* _qdl_get_bus_name(qdl_dscr_t dscr, char* buffer)
 	return buffer;
 }
 
+/**
+ * _qdl_init_dev_attrs
+ * @dscr: QDL descriptor
+ *
+ * Encodes bus name and location attributes of the device once. Every request addressed to the device
+ * starts with them and copies them with a single memcpy.
+ */
+void _qdl_init_dev_attrs(qdl_dscr_t dscr)
+{
+	qdl_struct *dscr_data = (qdl_struct*)dscr;
+	char bus_name_buff[QDL_PCI_LOCATION_NAME_LENGTH];
+	uint32_t size = 0;
+
+	memset(bus_name_buff, 0, sizeof(bus_name_buff));
+	_qdl_get_bus_name(dscr, bus_name_buff);
+	size = _qdl_encode_attr(dscr_data->dev_attrs, QDL_DEVLINK_ATTR_BUS_NAME, QDL_BUS_NAME_PCI,
+				sizeof(QDL_BUS_NAME_PCI));
+	size += _qdl_encode_attr(dscr_data->dev_attrs + size, QDL_DEVLINK_ATTR_LOCATION, bus_name_buff,
+				 strlen(bus_name_buff) + 1);
+	dscr_data->dev_attrs_size = size;
+}
+
 /**
  * _qdl_get_snapshot_id
  * @dscr: QDL descriptor
@@ -232,27 +495,77 @@ qdl_status_t _qdl_init_dscr(qdl_dscr_t dscr, uint32_t flags)
 	    }
 	}
 
-	/* Initialize optional resources */
+	/* Initialize optional resources. In info-only mode regions are only marked and snapshots are
+	 * created when the region is read for the first time. */
 	if(flags & QDL_INIT_NVM) {
 		qdl_dscr->flash_region.name = QDL_REGION_NAME_FLASH;
-		status = qdl_init_region(dscr, &qdl_dscr->flash_region, true);
-		if(status != QDL_SUCCESS) {
-			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_init_region (flash)", status);
-			return status;
+		if(flags & QDL_INIT_INFO_ONLY) {
+			qdl_dscr->flash_region.deferred = true;
+		} else {
+			status = qdl_init_region(dscr, &qdl_dscr->flash_region, true);
+			if(status != QDL_SUCCESS) {
+				QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_init_region (flash)", status);
+				return status;
+			}
 		}
 	}
 	if(flags & QDL_INIT_CAPS) {
 		qdl_dscr->caps_region.name = QDL_REGION_NAME_CAPS;
-		status = qdl_init_region(dscr, &qdl_dscr->caps_region, true);
-		if(status != QDL_SUCCESS) {
-			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_init_region (caps)", status);
-			return status;
+		if(flags & QDL_INIT_INFO_ONLY) {
+			qdl_dscr->caps_region.deferred = true;
+		} else {
+			status = qdl_init_region(dscr, &qdl_dscr->caps_region, true);
+			if(status != QDL_SUCCESS) {
+				QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_init_region (caps)", status);
+				return status;
+			}
 		}
 	}
 
 	return QDL_SUCCESS;
 }
 
+/**
+ * _qdl_init_deferred_region
+ * @dscr: QDL descriptor
+ * @region_name: region name
+ *
+ * Creates snapshot for region which setup was deferred by QDL_INIT_INFO_ONLY. Does nothing if the
+ * region is not deferred.
+ * Returns QDL_SUCCESS if function succeeds, otherwise error code.
+ */
+qdl_status_t _qdl_init_deferred_region(qdl_dscr_t dscr, char *region_name)
+{
+	qdl_struct *dscr_data = (qdl_struct*)dscr;
+	qdl_region_t *region = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+
+	if(region_name == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	if(strcmp(region_name, QDL_REGION_NAME_FLASH) == 0) {
+		region = &dscr_data->flash_region;
+	} else if(strcmp(region_name, QDL_REGION_NAME_CAPS) == 0) {
+		region = &dscr_data->caps_region;
+	} else {
+		return QDL_INVALID_PARAMS;
+	}
+
+	if(region->deferred == false) {
+		return QDL_SUCCESS;
+	}
+
+	status = qdl_init_region(dscr, region, true);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_init_region", status);
+		return status;
+	}
+	region->deferred = false;
+
+	return QDL_SUCCESS;
+}
+
 /**
  * _qdl_read_msg_family_id
  * @dscr: QDL descriptor
@@ -263,7 +576,7 @@ qdl_status_t _qdl_init_dscr(qdl_dscr_t dscr, uint32_t flags)
  */
 qdl_status_t _qdl_read_msg_family_id(qdl_dscr_t dscr, uint32_t *family_id)
 {
-	uint8_t *send_buff = NULL;
+	qdl_session_struct *session = ((qdl_struct*)dscr)->session;
 	uint8_t *rec_buff = NULL;
 	uint8_t *msg = NULL;
 	qdl_status_t status = QDL_SUCCESS;
@@ -272,32 +585,23 @@ qdl_status_t _qdl_read_msg_family_id(qdl_dscr_t dscr, uint32_t *family_id)
 	unsigned int msg_size = 0;
 
 	/* Create message */
-	send_buff = _qdl_create_generic_msg(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, &send_buff_size);
-	if(send_buff == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_create_generic_msg", 0);
-		return QDL_MEMORY_ERROR;
+	status = _qdl_build_generic_msg(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, (uint8_t*)session->send_buff,
+					sizeof(session->send_buff), &send_buff_size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_build_generic_msg", status);
+		return status;
 	}
 
 	/* Get device information */
-	status = qdl_send_msg(dscr, send_buff, send_buff_size);
-	free(send_buff);
+	status = qdl_send_msg(dscr, (uint8_t*)session->send_buff, send_buff_size);
 	if(status != QDL_SUCCESS) {
 		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_send_msg", status);
 		return status;
 	}
 
-	rec_buff_size = QDL_REC_BUFF_SIZE;
-	rec_buff = malloc(rec_buff_size);
-	if(rec_buff == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
-		return QDL_MEMORY_ERROR;
-	}
-	memset(rec_buff, 0, rec_buff_size);
-
-	status = qdl_receive_msg(dscr, rec_buff, &rec_buff_size);
+	status = _qdl_receive_reply(dscr, &rec_buff, &rec_buff_size);
 	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_receive_msg", status);
-		free(rec_buff);
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_reply", status);
 		return status;
 	}
 
@@ -306,10 +610,8 @@ qdl_status_t _qdl_read_msg_family_id(qdl_dscr_t dscr, uint32_t *family_id)
 	status = _qdl_get_uint32_attr(msg, msg_size, CTRL_ATTR_FAMILY_ID, family_id);
 	if(status != QDL_SUCCESS) {
 		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_uint32_attr", status);
-		free(rec_buff);
 		return status;
 	}
-	free(rec_buff);
 
 	return QDL_SUCCESS;
 }
@@ -326,23 +628,16 @@ qdl_status_t _qdl_read_msg_family_id(qdl_dscr_t dscr, uint32_t *family_id)
  */
 qdl_status_t _qdl_is_dev_supported(qdl_dscr_t dscr, bool *support)
 {
+	qdl_struct *dscr_data = (qdl_struct*)dscr;
 	uint8_t *rec_buff = NULL;
 	uint8_t *msg = NULL;
 	qdl_status_t status = QDL_SUCCESS;
-	unsigned int rec_buff_size = QDL_REC_BUFF_SIZE;
+	unsigned int rec_buff_size = 0;
 
 	/* Get list of supported devices */
-	rec_buff = malloc(rec_buff_size);
-	if(rec_buff == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", status);
-		return QDL_MEMORY_ERROR;
-	}
-	memset(rec_buff, 0, rec_buff_size);
-
-	status = qdl_receive_reply_msg(dscr, QDL_CMD_GET, NULL, rec_buff, &rec_buff_size);
+	status = _qdl_receive_pooled_reply_msg(dscr, QDL_CMD_GET, NULL, &rec_buff, &rec_buff_size);
 	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_receive_reply_msg", status);
-		free(rec_buff);
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_pooled_reply_msg", status);
 		return status;
 	}
 
@@ -351,58 +646,39 @@ qdl_status_t _qdl_is_dev_supported(qdl_dscr_t dscr, bool *support)
 	*support = false;
 	msg = _qdl_get_next_dev_msg(dscr, rec_buff, rec_buff_size, NULL);
 	if(msg == NULL) {
-		free(rec_buff);
 		return QDL_SUCCESS;
 	}
 
 	/* Verify supported cmds. If cmd is not supported return 'false' for 'support' and ends function
 	 *  with success. */
-	rec_buff_size = QDL_REC_BUFF_SIZE;
-	memset(rec_buff, 0, rec_buff_size);
-	status = qdl_receive_reply_msg(dscr, QDL_CMD_INFO_GET, NULL, rec_buff, &rec_buff_size);
+	status = _qdl_receive_pooled_reply_msg(dscr, QDL_CMD_INFO_GET, NULL, &rec_buff, &rec_buff_size);
 	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_receive_reply_msg", status);
-		free(rec_buff);
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_pooled_reply_msg", status);
 		return QDL_SUCCESS;
 	}
 	*support = true;
 
-	/*  Free memory */
-	free(rec_buff);
-
-	return QDL_SUCCESS;
-}
-
-/**
- * qdl_get_socket
- *
- * Gets socket descriptor for Devlink communication.
- * Returns file descriptor for open socket if the function succeeds, otherwise 0.
- */
-int _qdl_get_socket(void)
-{
-	if(qdl_socket == QDL_INVALID_SOCKET) {
-		qdl_socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
-		if(qdl_socket != QDL_INVALID_SOCKET) {
-			qdl_socket_count++;
-		}
-	} else {
-		qdl_socket_count++;
+	/* Keep INFO_GET reply as the info snapshot for later queries. Snapshot is optional, so memory
+	 * error is not reported. */
+	dscr_data->info_snapshot = malloc(rec_buff_size);
+	if(dscr_data->info_snapshot != NULL) {
+		memcpy(dscr_data->info_snapshot, rec_buff, rec_buff_size);
+		dscr_data->info_snapshot_size = rec_buff_size;
 	}
 
-	return qdl_socket;
+	return QDL_SUCCESS;
 }
 
 /**
- * qdl_open_socket
- * @dscr: QDL descriptor
+ * _qdl_open_session
+ * @session: session to open
  *
- * Opens socket for Devlink communication.
- * Returns 0 if success, otherwise an error code.
+ * Opens and binds netlink socket of the session. Port ID is assigned by the kernel, so every thread
+ * of the process can bind its own socket.
+ * Returns QDL_SUCCESS if function succeeds, otherwise error code.
  */
-int _qdl_open_socket(qdl_dscr_t qdl_dscr)
+qdl_status_t _qdl_open_session(qdl_session_struct *session)
 {
-	qdl_struct *dscr = (qdl_struct*)qdl_dscr;
 	int return_code = 0;
 	int address_length = sizeof(struct sockaddr_nl);
 #ifndef QDL_NO_EXT_ACK
@@ -410,33 +686,28 @@ int _qdl_open_socket(qdl_dscr_t qdl_dscr)
 #endif
 
 	/* Get devlink socket */
-	dscr->socket = _qdl_get_socket();
-	if(dscr->socket == QDL_SOCKET_ERROR) {
+	session->socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+	if(session->socket == QDL_SOCKET_ERROR) {
 		return QDL_OPEN_SOCKET_ERROR;
 	}
 
-	/* Check if socket is opened already */
-	if(qdl_socket_count > 1) {
-		return QDL_SUCCESS;
-	}
-
 	/* Bind */
-	dscr->socket_addr.nl_family = AF_NETLINK;
-	dscr->socket_addr.nl_groups = 0;
-	dscr->socket_addr.nl_pid = getpid();
-	return_code = bind(dscr->socket, (struct sockaddr*)&dscr->socket_addr, address_length);
+	session->socket_addr.nl_family = AF_NETLINK;
+	session->socket_addr.nl_groups = 0;
+	session->socket_addr.nl_pid = 0;
+	return_code = bind(session->socket, (struct sockaddr*)&session->socket_addr, address_length);
 	if(return_code == QDL_SOCKET_ERROR) {
 		return QDL_OPEN_SOCKET_ERROR;
 	}
 
-	return_code = getsockname(dscr->socket, (struct sockaddr*)&dscr->socket_addr,
+	return_code = getsockname(session->socket, (struct sockaddr*)&session->socket_addr,
 				  (socklen_t*)&address_length);
 	if(return_code == QDL_SOCKET_ERROR) {
 		return QDL_OPEN_SOCKET_ERROR;
 	}
 
 #ifndef QDL_NO_EXT_ACK
-	return_code = setsockopt(dscr->socket, SOL_NETLINK, NETLINK_EXT_ACK, &sock_opt, sizeof(sock_opt));
+	return_code = setsockopt(session->socket, SOL_NETLINK, NETLINK_EXT_ACK, &sock_opt, sizeof(sock_opt));
 	if(return_code) {
 		return QDL_OPEN_SOCKET_ERROR;
 	}
@@ -446,61 +717,132 @@ int _qdl_open_socket(qdl_dscr_t qdl_dscr)
 }
 
 /**
- * qdl_receive_msg
- * @dscr: QDL descriptor
- * @rec_msg_buff: buffer for received message
- * @rec_msg_size: buffer size
+ * _qdl_free_session
+ * @session: session to release
  *
- * Receives message.
- * Returns QDL_SUCCESS if the function succeeds, otherwise an error code.
+ * Closes socket of the session and releases its memory. Called for the session of exiting thread.
  */
-qdl_status_t _qdl_receive_msg(qdl_dscr_t dscr, uint8_t *rec_msg_buff, unsigned int *rec_msg_size)
+void _qdl_free_session(void *session)
 {
-	struct msghdr rec_msg;
-	struct iovec iov;
-	qdl_struct *dscr_data = (qdl_struct*)dscr;
-	int return_value = 0;
+	qdl_session_struct *session_data = (qdl_session_struct*)session;
 
-	/* Validate input parameters */
-	if(dscr == NULL || rec_msg_buff == NULL || rec_msg_size == NULL) {
-		return QDL_INVALID_PARAMS;
+	if(session_data == NULL) {
+		return;
 	}
+	if(session_data->socket != QDL_SOCKET_ERROR) {
+		close(session_data->socket);
+	}
+	free(session_data->rec_buff);
+	free(session_data);
+}
 
-	/* Initialize parameters */
-	memset(&rec_msg, 0, sizeof(rec_msg));
-	memset(&iov, 0, sizeof(iov));
+/**
+ * _qdl_create_session_key
+ *
+ * Creates thread specific key of the sessions, so the session is released when its thread exits.
+ */
+void _qdl_create_session_key(void)
+{
+	if(pthread_key_create(&qdl_session_key, _qdl_free_session) == 0) {
+		qdl_session_key_ready = true;
+	}
+}
 
-	/* Receive message */
-	iov.iov_base = rec_msg_buff;
-	iov.iov_len = *rec_msg_size;
-	rec_msg.msg_name = &dscr_data->socket_addr;
-	rec_msg.msg_namelen = sizeof(dscr_data->socket_addr);
-	rec_msg.msg_iov = &iov;
-	rec_msg.msg_iovlen = 1;
-	rec_msg.msg_control = NULL;
-	rec_msg.msg_controllen = 0;
-	rec_msg.msg_flags = 0;
-	return_value = recvmsg(dscr_data->socket, &rec_msg, 0);
-	if(return_value == -1) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("recvmsg", errno);
-		return QDL_RECEIVE_MSG_ERROR;
+/**
+ * _qdl_detach_session
+ * @dscr: QDL descriptor
+ *
+ * Detaches descriptor from its session. Session stays open for next descriptors of the thread.
+ */
+void _qdl_detach_session(qdl_dscr_t qdl_dscr)
+{
+	qdl_struct *dscr = (qdl_struct*)qdl_dscr;
+
+	if(dscr->session == NULL) {
+		return;
 	}
-	*rec_msg_size = return_value;
+	dscr->session->dscr_count--;
+	dscr->session = NULL;
+	dscr->socket = QDL_INVALID_SOCKET;
+}
 
-	/* Buffer is too small */
-	if(rec_msg.msg_flags & MSG_TRUNC) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("msg_flags", MSG_TRUNC);
-		return QDL_RECEIVE_MSG_ERROR;
+/**
+ * _qdl_attach_session
+ * @dscr: QDL descriptor
+ *
+ * Attaches descriptor to the netlink session of the calling thread. Session is opened by the first
+ * descriptor of the thread. Descriptor must be used only by the thread it was attached in.
+ * Returns QDL_SUCCESS if function succeeds, otherwise error code.
+ */
+qdl_status_t _qdl_attach_session(qdl_dscr_t qdl_dscr)
+{
+	qdl_struct *dscr = (qdl_struct*)qdl_dscr;
+	qdl_session_struct *session = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+
+	pthread_once(&qdl_session_key_once, _qdl_create_session_key);
+	if(qdl_session_key_ready == false) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("pthread_key_create", 0);
+		return QDL_INIT_ERROR;
 	}
 
-	if(rec_msg.msg_namelen != sizeof(struct sockaddr_nl)) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("msg_namelen", rec_msg.msg_namelen);
-		return QDL_RECEIVE_MSG_ERROR;
+	session = (qdl_session_struct*)pthread_getspecific(qdl_session_key);
+	if(session == NULL) {
+		session = calloc(1, sizeof(qdl_session_struct));
+		if(session == NULL) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("calloc", 0);
+			return QDL_MEMORY_ERROR;
+		}
+
+		status = _qdl_open_session(session);
+		if(status == QDL_SUCCESS && pthread_setspecific(qdl_session_key, session) != 0) {
+			status = QDL_INIT_ERROR;
+		}
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_open_session", status);
+			_qdl_free_session(session);
+			return status;
+		}
 	}
 
+	session->dscr_count++;
+	dscr->session = session;
+	dscr->socket = session->socket;
+	dscr->socket_addr = session->socket_addr;
+
 	return QDL_SUCCESS;
 }
 
+/**
+ * _qdl_get_family_id
+ * @dscr: QDL descriptor
+ * @family_id: Devlink family ID
+ *
+ * Gets Devlink generic netlink family ID. ID is fixed for the life of the kernel, so it is read
+ * once per process with the session of the first caller and reused by all descriptors. Failed read
+ * is retried by the next caller.
+ * Returns QDL_SUCCESS if function succeeds, otherwise error code.
+ */
+qdl_status_t _qdl_get_family_id(qdl_dscr_t dscr, uint32_t *family_id)
+{
+	qdl_status_t status = QDL_SUCCESS;
+	uint32_t id = QDL_INVALID_FAMILY_ID;
+
+	pthread_mutex_lock(&qdl_family_id_lock);
+	if(qdl_family_id == QDL_INVALID_FAMILY_ID) {
+		status = _qdl_read_msg_family_id(dscr, &id);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_read_msg_family_id", status);
+		} else {
+			qdl_family_id = id;
+		}
+	}
+	*family_id = qdl_family_id;
+	pthread_mutex_unlock(&qdl_family_id_lock);
+
+	return status;
+}
+
 /*************************************************************************************************************
  * QDL API
  */
@@ -529,47 +871,295 @@ qdl_status_t qdl_get_string_by_type(qdl_dscr_t dscr, uint8_t *buff, uint32_t buf
 		return status;
 	}
 
-	msg = _qdl_get_next_dev_msg(dscr, buff, buff_size, NULL);
-	if(msg != NULL) {
-		msg_size = buff + buff_size - msg;
-		status = _qdl_get_string_attr(msg, msg_size, type, string, string_size);
-	}
+	msg = _qdl_get_next_dev_msg(dscr, buff, buff_size, NULL);
+	if(msg != NULL) {
+		msg_size = buff + buff_size - msg;
+		status = _qdl_get_string_attr(msg, msg_size, type, string, string_size);
+	}
+
+	return status;
+}
+
+/**
+ * qdl_get_string_by_key
+ * @dscr: QDL descriptor
+ * @buff: buffer with messages
+ * @buff_size: buffer size
+ * key: key name for the searched value
+ * @value: buffer for a value of the child nested attribute
+ * @value_size: buffer size of the value
+ *
+ * Some nested attributes contains pair of child attributes organized as key and value. The function gets
+ * value of child attribute based on provided key string.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_get_string_by_key(qdl_dscr_t dscr, uint8_t *buff, uint32_t buff_size, char *key,
+		char *value, int value_size)
+{
+	uint8_t *msg = NULL;
+	qdl_status_t status = QDL_INVALID_PARAMS;
+	unsigned int msg_size = 0;
+
+	/* Validate input parameters */
+	if(dscr == NULL || buff == NULL || buff_size == 0 || key == NULL || value == NULL
+			|| value_size == 0) {
+		return status;
+	}
+
+	msg = _qdl_get_next_dev_msg(dscr, buff, buff_size, NULL);
+	if(msg != NULL) {
+		msg_size = buff + buff_size - msg;
+		status = _qdl_get_string_nattr_by_key(msg, msg_size, key, value, value_size);
+	}
+
+	return status;
+}
+
+/**
+ * qdl_get_msg_string_by_key
+ * @msg: single device message
+ * @msg_size: message size
+ * @key: key name for the searched value
+ * @value: buffer for a value of the child nested attribute
+ * @value_size: buffer size of the value
+ *
+ * Works like qdl_get_string_by_key() for a message already selected for the device, e.g. by
+ * qdl_dump_dev_info() callback. Value is always null terminated.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_get_msg_string_by_key(uint8_t *msg, unsigned int msg_size, char *key, char *value,
+				       int value_size)
+{
+	qdl_status_t status = QDL_INVALID_PARAMS;
+
+	/* Validate input parameters */
+	if(msg == NULL || msg_size == 0 || key == NULL || value == NULL || value_size <= 1) {
+		return status;
+	}
+
+	memset(value, 0, value_size);
+	status = _qdl_get_string_nattr_by_key(msg, msg_size, key, value, value_size - 1);
+
+	return status;
+}
+
+/**
+ * qdl_index_msg
+ * @msg: single device message
+ * @msg_size: message size
+ * @index: message index to build
+ *
+ * Walks the message once and builds the index used by qdl_get_indexed_string_by_key(). The index
+ * points into the message, so the message must stay valid while the index is used.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_index_msg(uint8_t *msg, unsigned int msg_size, qdl_msg_index_t *index)
+{
+	/* Validate input parameters */
+	if(msg == NULL || msg_size == 0 || index == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	return _qdl_build_msg_index(msg, msg_size, index);
+}
+
+/**
+ * qdl_index_dev_msg
+ * @dscr: QDL descriptor
+ * @buff: buffer with messages
+ * @buff_size: buffer size
+ * @index: message index to build
+ *
+ * Builds the index for the message of device 'dscr' found in the buffer.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_index_dev_msg(qdl_dscr_t dscr, uint8_t *buff, uint32_t buff_size, qdl_msg_index_t *index)
+{
+	uint8_t *msg = NULL;
+
+	/* Validate input parameters */
+	if(dscr == NULL || buff == NULL || buff_size == 0 || index == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	msg = _qdl_get_next_dev_msg(dscr, buff, buff_size, NULL);
+	if(msg == NULL) {
+		return QDL_DEVICE_NOT_FOUND;
+	}
+
+	return _qdl_build_msg_index(msg, buff + buff_size - msg, index);
+}
+
+/**
+ * qdl_get_indexed_string_by_key
+ * @index: message index
+ * @key: key name for the searched value
+ * @value: buffer for a value of the child nested attribute
+ * @value_size: buffer size of the value
+ *
+ * Works like qdl_get_string_by_key() but the key is found in the message index without parsing
+ * the message. Value is always null terminated.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_get_indexed_string_by_key(qdl_msg_index_t *index, char *key, char *value, int value_size)
+{
+	/* Validate input parameters */
+	if(index == NULL || index->msg == NULL || key == NULL || value == NULL || value_size <= 1) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	memset(value, 0, value_size);
+
+	return _qdl_get_indexed_string_nattr_by_key(index, key, value, value_size - 1);
+}
+
+/**
+ * qdl_get_info_snapshot
+ * @dscr: QDL descriptor
+ * @buff: returned buffer with INFO_GET reply
+ * @buff_size: returned buffer size
+ *
+ * Gets INFO_GET reply read for the device during qdl_init_dev(). The buffer is owned by the
+ * descriptor and is valid until qdl_release_dev(). It can be parsed with qdl_get_string_by_key().
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_get_info_snapshot(qdl_dscr_t dscr, uint8_t **buff, unsigned int *buff_size)
+{
+	qdl_struct *dscr_data = (qdl_struct*)dscr;
+
+	/* Validate input parameters */
+	if(dscr == NULL || buff == NULL || buff_size == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	if(dscr_data->info_snapshot == NULL || dscr_data->info_snapshot_size == 0) {
+		return QDL_PARSE_MSG_ERROR;
+	}
+	*buff = dscr_data->info_snapshot;
+	*buff_size = dscr_data->info_snapshot_size;
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * qdl_dump_dev_info
+ * @callback: function called for every device reported by Devlink
+ * @context: user data passed to the callback
+ *
+ * Sends one INFO_GET request with NLM_F_DUMP flag and walks the multi-part reply, so information
+ * about all Devlink devices on the host is read in a single round trip. After the first callback
+ * error the rest of the dump is received and dropped, so the session stays usable.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_dump_dev_info(qdl_dev_msg_callback_t callback, void *context)
+{
+	char location[QDL_DEV_LOCATION_SIZE];
+	struct nlmsgerr *error = NULL;
+	qdl_struct *dscr_data = NULL;
+	qdl_dscr_t dscr = NULL;
+	uint8_t *send_buff = NULL;
+	uint8_t *rec_buff = NULL;
+	uint8_t *msg = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+	qdl_status_t callback_status = QDL_SUCCESS;
+	unsigned int send_buff_size = 0;
+	unsigned int rec_buff_size = 0;
+	unsigned int msg_size = 0;
+	unsigned int segment = 0;
+	unsigned int bus = 0;
+	unsigned int device = 0;
+	unsigned int function = 0;
+	bool done = false;
+
+	QDL_DEBUGLOG_ENTERING;
+
+	if(callback == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	/* Descriptor not bound to any device - only the session socket is used */
+	dscr_data = malloc(sizeof(qdl_struct));
+	if(dscr_data == NULL) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
+		return QDL_MEMORY_ERROR;
+	}
+	memset(dscr_data, 0, sizeof(qdl_struct));
+	dscr_data->flash_region.snapshot_id = QDL_INVALID_SNAPSHOT_ID;
+	dscr_data->caps_region.snapshot_id = QDL_INVALID_SNAPSHOT_ID;
+	dscr = (qdl_dscr_t)dscr_data;
+
+	do {
+		status = _qdl_attach_session(dscr);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_attach_session", status);
+			break;
+		}
+
+		status = _qdl_get_family_id(dscr, &dscr_data->id);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_family_id", status);
+			break;
+		}
 
-	return status;
-}
+		/* INFO_GET without device location and with dump flag */
+		send_buff = (uint8_t*)dscr_data->session->send_buff;
+		_qdl_put_msg_header(send_buff, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+		_qdl_put_msg_extra_header(send_buff, QDL_CMD_INFO_GET, 1);
+		send_buff_size = ((struct nlmsghdr*)send_buff)->nlmsg_len;
 
-/**
- * qdl_get_string_by_key
- * @dscr: QDL descriptor
- * @buff: buffer with messages
- * @buff_size: buffer size
- * key: key name for the searched value
- * @value: buffer for a value of the child nested attribute
- * @value_size: buffer size of the value
- *
- * Some nested attributes contains pair of child attributes organized as key and value. The function gets
- * value of child attribute based on provided key string.
- * Returns QDL_SUCCESS if success, otherwise error code.
- */
-qdl_status_t qdl_get_string_by_key(qdl_dscr_t dscr, uint8_t *buff, uint32_t buff_size, char *key,
-		char *value, int value_size)
-{
-	uint8_t *msg = NULL;
-	qdl_status_t status = QDL_INVALID_PARAMS;
-	unsigned int msg_size = 0;
+		status = qdl_send_msg(dscr, send_buff, send_buff_size);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("qdl_send_msg", status);
+			break;
+		}
 
-	/* Validate input parameters */
-	if(dscr == NULL || buff == NULL || buff_size == 0 || key == NULL || value == NULL
-			|| value_size == 0) {
-		return status;
-	}
+		/* Every part of the reply is handled before the next one is received */
+		while(done == false && status == QDL_SUCCESS) {
+			status = _qdl_receive_part(dscr, 0, &rec_buff_size);
+			if(status != QDL_SUCCESS) {
+				QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_part", status);
+				break;
+			}
+			rec_buff = dscr_data->session->rec_buff;
+
+			msg = _qdl_get_next_msg(rec_buff, rec_buff_size, NULL);
+			while(msg != NULL) {
+				if(_qdl_is_ctrl_msg((struct nlmsghdr*)msg)) {
+					if(((struct nlmsghdr*)msg)->nlmsg_type == NLMSG_ERROR) {
+						error = (struct nlmsgerr*)_qdl_get_msg_data_addr(msg);
+						if(error->error != 0) {
+							QDL_DEBUGLOG_FUNCTION_FAIL("INFO_GET dump", error->error);
+							status = QDL_RECEIVE_MSG_ERROR;
+						}
+					}
+					done = true;
+					break;
+				}
+
+				/* After a callback error the remaining messages are only drained */
+				msg_size = rec_buff + rec_buff_size - msg;
+				memset(location, '\0', QDL_DEV_LOCATION_SIZE);
+				if(callback_status == QDL_SUCCESS &&
+				   _qdl_get_string_attr(msg, msg_size, QDL_DEVLINK_ATTR_LOCATION, location,
+							QDL_DEV_LOCATION_SIZE) == QDL_SUCCESS &&
+				   sscanf(location, "%04X:%02X:%02X.%1X", &segment, &bus, &device, &function) == 4) {
+					callback_status = callback(segment, bus, device, function, msg,
+								   ((struct nlmsghdr*)msg)->nlmsg_len, context);
+					if(callback_status != QDL_SUCCESS) {
+						QDL_DEBUGLOG_FUNCTION_FAIL("callback", callback_status);
+					}
+				}
+				msg = _qdl_get_next_msg(rec_buff, rec_buff_size, msg);
+			}
+		}
+	} while(0);
 
-	msg = _qdl_get_next_dev_msg(dscr, buff, buff_size, NULL);
-	if(msg != NULL) {
-		msg_size = buff + buff_size - msg;
-		status = _qdl_get_string_nattr_by_key(msg, msg_size, key, value, value_size);
+	if(status == QDL_SUCCESS) {
+		status = callback_status;
 	}
 
+	qdl_release_dev(dscr);
+
 	return status;
 }
 
@@ -650,6 +1240,154 @@ qdl_status_t qdl_read_region(qdl_dscr_t dscr, uint8_t *msg_buff, uint32_t msg_bu
 	return QDL_SUCCESS;
 }
 
+/**
+ * qdl_get_region_size
+ * @dscr: QDL descriptor
+ * @region_name: region name
+ * @size: returned region size in bytes
+ *
+ * Reads size of the region reported by REGION_GET.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_get_region_size(qdl_dscr_t dscr, char *region_name, uint64_t *size)
+{
+	qdl_region_t region;
+	uint8_t *rec_buff = NULL;
+	uint8_t *msg = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+	unsigned int rec_buff_size = 0;
+
+	QDL_DEBUGLOG_ENTERING;
+
+	/* Validate input parameters */
+	if(dscr == NULL || region_name == NULL || size == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	memset(&region, 0, sizeof(region));
+	region.name = region_name;
+	status = _qdl_receive_pooled_reply_msg(dscr, QDL_CMD_REGION_GET, &region, &rec_buff, &rec_buff_size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_pooled_reply_msg", status);
+		return status;
+	}
+
+	msg = _qdl_get_next_msg(rec_buff, rec_buff_size, NULL);
+	if(msg == NULL || _qdl_is_ctrl_msg((struct nlmsghdr*)msg)) {
+		return QDL_PARSE_MSG_ERROR;
+	}
+	status = _qdl_get_uint64_attr(msg, rec_buff + rec_buff_size - msg, QDL_DEVLINK_ATTR_REGION_SIZE, size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_uint64_attr", status);
+		return status;
+	}
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * qdl_read_region_stream
+ * @dscr: QDL descriptor
+ * @region_name: region name
+ * @address: address of the region to read
+ * @length: length of the region to read
+ * @callback: function called for every chunk of the region
+ * @context: user data passed to the callback
+ *
+ * Reads region with REGION_READ dump and passes every chunk to the callback as soon as the dump
+ * message carrying it is received. Only one dump message is kept in memory at a time, so the read
+ * runs in constant memory regardless of the region size. If the callback fails the rest of the dump
+ * is received and dropped, so the session stays usable.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_read_region_stream(qdl_dscr_t dscr, char *region_name, uint64_t address, uint64_t length,
+				    qdl_region_chunk_callback_t callback, void *context)
+{
+	qdl_msg_region_read_t region_read;
+	struct nlmsgerr *error = NULL;
+	uint8_t *rec_buff = NULL;
+	uint8_t *msg = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+	qdl_status_t read_status = QDL_SUCCESS;
+	uint64_t next_address = address;
+	unsigned int part_size = 0;
+	bool done = false;
+
+	QDL_DEBUGLOG_ENTERING;
+
+	/* Validate input parameters */
+	if(dscr == NULL || region_name == NULL || callback == NULL || length == 0) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	status = _qdl_init_deferred_region(dscr, region_name);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_init_deferred_region", status);
+		return status;
+	}
+
+	memset(&region_read, 0, sizeof(region_read));
+	region_read.region = region_name;
+	region_read.address = address;
+	region_read.length = length;
+
+	/* Kernel sizes dump messages by the receive buffer offered in the previous recvmsg(), so the
+	 * largest buffer netlink uses is offered up front to get the fewest messages per region. */
+	status = _qdl_reserve_rec_buff(dscr, QDL_REGION_READ_BUFF_SIZE);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_reserve_rec_buff", status);
+		return status;
+	}
+
+	status = _qdl_send_request(dscr, QDL_CMD_REGION_READ, &region_read);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_send_request", status);
+		return status;
+	}
+
+	while(done == false) {
+		status = _qdl_receive_part(dscr, 0, &part_size);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_part", status);
+			return status;
+		}
+
+		rec_buff = ((qdl_struct*)dscr)->session->rec_buff;
+		msg = _qdl_get_next_msg(rec_buff, part_size, NULL);
+		while(msg != NULL) {
+			if(_qdl_is_ctrl_msg((struct nlmsghdr*)msg)) {
+				if(((struct nlmsghdr*)msg)->nlmsg_type == NLMSG_ERROR) {
+					error = (struct nlmsgerr*)_qdl_get_msg_data_addr(msg);
+					if(error->error != 0 && read_status == QDL_SUCCESS) {
+						QDL_DEBUGLOG_FUNCTION_FAIL("REGION_READ", error->error);
+						read_status = QDL_RECEIVE_MSG_ERROR;
+					}
+				}
+				done = true;
+				break;
+			}
+
+			/* After an error the remaining messages are only drained */
+			if(read_status == QDL_SUCCESS) {
+				read_status = _qdl_walk_region_chunks(msg, rec_buff + part_size - msg, &next_address,
+								      callback, context);
+				if(read_status != QDL_SUCCESS) {
+					QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_walk_region_chunks", read_status);
+				}
+			}
+			msg = _qdl_get_next_msg(rec_buff, part_size, msg);
+		}
+	}
+
+	/* Whole requested range has to be delivered */
+	if(read_status == QDL_SUCCESS && next_address != address + length) {
+		QDL_DEBUGLOG_ERROR_MSG("Region read incomplete.");
+		read_status = QDL_CORRUPTED_MSG_ERROR;
+	}
+
+	return read_status;
+}
+
 /**
  * qdl_get_param_value
  * @dscr: QDL descriptor
@@ -814,217 +1552,257 @@ qdl_status_t qdl_receive_msg(qdl_dscr_t dscr, uint8_t *rec_buff, unsigned int *r
 qdl_status_t qdl_receive_reply_msg(qdl_dscr_t dscr, int cmd_type, void *data, uint8_t *reply_buff,
 		unsigned int *reply_buff_size)
 {
-	uint8_t *send_buff = NULL;
-	uint8_t *buff = NULL;
 	uint8_t *rec_buff = NULL;
 	qdl_status_t status = QDL_SUCCESS;
-	unsigned int send_buff_size = 0;
 	unsigned int rec_buff_size = 0;
 
 	QDL_DEBUGLOG_ENTERING;
 
-	/* Create message based on command type */
-	send_buff = qdl_create_msg(dscr, cmd_type, &send_buff_size, data);
-	if(send_buff == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_create_msg error", 0);
-		return QDL_CREATE_MSG_ERROR;
-	}
-
-	/* Send message */
-	status = qdl_send_msg(dscr, send_buff, send_buff_size);
-	free(send_buff);
-	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_send_msg error", status);
-		return status;
+	/* Create deferred region snapshot before the first read */
+	if(cmd_type == QDL_CMD_REGION_READ && dscr != NULL && data != NULL) {
+		status = _qdl_init_deferred_region(dscr, ((qdl_msg_region_read_t*)data)->region);
+		if(status != QDL_SUCCESS) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_init_deferred_region", status);
+			return status;
+		}
 	}
 
-	/* Check if reply buffer was provided */
-	if(reply_buff != NULL && reply_buff_size != NULL) {
-		rec_buff_size = *reply_buff_size;
-		rec_buff = reply_buff;
-	} else if(reply_buff != NULL || reply_buff_size != NULL) {
+	/* Without reply buffer only the status is checked - the session receive buffer is used */
+	if(reply_buff == NULL && reply_buff_size == NULL) {
+		return _qdl_receive_pooled_reply_msg(dscr, cmd_type, data, &rec_buff, &rec_buff_size);
+	} else if(reply_buff == NULL || reply_buff_size == NULL) {
 		QDL_DEBUGLOG_ERROR_MSG("Inconsistent input parameters.");
 		return QDL_INVALID_PARAMS;
-	} else {
-		rec_buff_size = QDL_REC_BUFF_SIZE;
-		buff = malloc(rec_buff_size);
-		if(buff == NULL) {
-			QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
-			return QDL_MEMORY_ERROR;
-		}
-		memset(buff, 0, rec_buff_size);
-		rec_buff = buff;
+	}
+
+	/* Create message based on command type and send it */
+	status = _qdl_send_request(dscr, cmd_type, data);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_send_request", status);
+		return status;
 	}
 
 	/* Receive reply for the sent message */
-	status = qdl_receive_msg(dscr, rec_buff, &rec_buff_size);
+	rec_buff_size = *reply_buff_size;
+	status = qdl_receive_msg(dscr, reply_buff, &rec_buff_size);
 	if(status != QDL_SUCCESS) {
 		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_receive_msg", status);
 		rec_buff_size = 0;
 	}
-	if(reply_buff_size != NULL) {
-		*reply_buff_size = rec_buff_size;
-	}
-
-	/* Release resources */
-	if(buff != NULL) {
-		free(buff);
-	}
+	*reply_buff_size = rec_buff_size;
 
 	return status;
 }
 
 /**
- * qdl_create_msg
+ * qdl_build_msg
  * @dscr: QDL descriptor
  * @cmd_type: command type of message
- * @msg_size: size of the created message
  * @data: optional message data dependent on cmd_type
+ * @msg: buffer for the message, at least _qdl_get_msg_size(cmd_type) (QDL_MSG_SIZE_*) bytes
+ * @msg_buff_size: buffer size
+ * @msg_size: size of the built message
  *
- * Allocates buffer for new message of type 'cmd_type' and fills with appropriate content. Notice that user
- * should free the allocated buffer.
- * Returns address to the created message if success, otherwise NULL.
+ * Builds message of type 'cmd_type' in the caller provided buffer. Nothing is allocated and the buffer
+ * does not need to be cleared. Bus name and location attributes are copied from the descriptor where
+ * they are encoded once.
+ * Returns QDL_SUCCESS if success, otherwise error code.
  */
-uint8_t* qdl_create_msg(qdl_dscr_t dscr, int cmd_type, unsigned int *msg_size, void* data)
+qdl_status_t qdl_build_msg(qdl_dscr_t dscr, int cmd_type, void *data, uint8_t *msg, unsigned int msg_buff_size,
+			   unsigned int *msg_size)
 {
-	char bus_name_buff[QDL_BUS_NAME_LENGTH];
 	qdl_struct *dscr_data = (qdl_struct*)dscr;
-	uint8_t *msg = NULL;
-
-	QDL_DEBUGLOG_ENTERING;
+	qdl_msg_param_set_t *param_set = NULL;
+	qdl_msg_region_read_t *region_read = NULL;
+	qdl_region_t *region = NULL;
+	uint16_t flags = NLM_F_REQUEST | NLM_F_ACK;
+	int size = 0;
 
 	/* Validate input parameters */
-	if(dscr == NULL || msg_size == NULL) {
-		return NULL;
+	if(dscr == NULL || msg == NULL || msg_size == NULL) {
+		return QDL_INVALID_PARAMS;
 	}
 
-	/* Allocate message buffer */
-	*msg_size = _qdl_get_msg_size(cmd_type);
-	if(*msg_size == 0) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_msg_size", (int)*msg_size);
-		return NULL;
+	size = _qdl_get_msg_size(cmd_type);
+	if(size == 0 || cmd_type == CTRL_CMD_GETFAMILY) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_msg_size", size);
+		return QDL_INVALID_PARAMS;
 	}
-	msg = malloc(*msg_size);
-	if(msg == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
-		return NULL;
+	if(msg_buff_size < (unsigned int)size) {
+		return QDL_BUFFER_TOO_SMALL_ERROR;
 	}
-	memset(msg, 0, *msg_size);
 
-	/* Fill the message with the content */
+	/* Validate data of variable size, so the message fits into its size bound */
 	switch(cmd_type) {
-	case QDL_CMD_GET:
-	case QDL_CMD_INFO_GET:
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
+	case QDL_CMD_PARAM_GET:
+		if(data == NULL || strlen((char*)data) >= QDL_PARAM_NAME_SIZE) {
+			return QDL_INVALID_PARAMS;
+		}
+		break;
+	case QDL_CMD_PARAM_SET:
+		param_set = (qdl_msg_param_set_t*)data;
+		if(param_set == NULL || param_set->minsrev_name == NULL ||
+		   strlen(param_set->minsrev_name) >= QDL_PARAM_NAME_SIZE) {
+			return QDL_INVALID_PARAMS;
+		}
+		break;
+	case QDL_CMD_REGION_GET:
+	case QDL_CMD_REGION_NEW:
+	case QDL_CMD_REGION_DEL:
+		region = (qdl_region_t*)data;
+		if(region == NULL || _qdl_validate_region_name(region->name) != QDL_SUCCESS) {
+			return QDL_INVALID_PARAMS;
+		}
+		break;
+	case QDL_CMD_REGION_READ:
+		region_read = (qdl_msg_region_read_t*)data;
+		if(region_read == NULL || _qdl_validate_region_name(region_read->region) != QDL_SUCCESS) {
+			return QDL_INVALID_PARAMS;
+		}
+		flags |= NLM_F_DUMP;
+		break;
+	case QDL_CMD_FLASH_UPDATE:
+		if(data == NULL || strlen((char*)data) >= QDL_FILE_NAME_MAX_LENGTH) {
+			return QDL_INVALID_PARAMS;
+		}
 		break;
 	case QDL_CMD_PORT_GET:
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
+		flags |= NLM_F_DUMP;
 		break;
+	default:
+		break;
+	}
+
+	/* Fill the message with the content */
+	_qdl_put_msg_header(msg, dscr_data->id, flags);
+	_qdl_put_msg_extra_header(msg, cmd_type, 1);
+	if(cmd_type != QDL_CMD_PORT_GET) {
+		_qdl_put_msg_attrs(msg, dscr_data->dev_attrs, dscr_data->dev_attrs_size);
+	}
+
+	switch(cmd_type) {
 	case QDL_CMD_PARAM_GET:
-		if(data == NULL) {
-			free(msg);
-			return NULL;
-		}
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
 		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_PARAM_NAME, (char*)data);
 		break;
 	case QDL_CMD_RELOAD:
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
 		_qdl_put_msg_uint8_attr(msg, QDL_DEVLINK_ATTR_RELOAD_ACTION, QDL_PARAM_RELOAD_ACTION_FW_ACTIVATE);
 		break;
 	case QDL_CMD_PARAM_SET:
-		if(data == NULL) {
-			free(msg);
-			return NULL;
-		}
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_PARAM_NAME,
-				      ((qdl_msg_param_set_t*)data)->minsrev_name);
+		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_PARAM_NAME, param_set->minsrev_name);
 		_qdl_put_msg_uint8_attr(msg, QDL_DEVLINK_ATTR_PARAM_VALUE_CMODE, QDL_PARAM_CMODE_PERMANENT);
 		_qdl_put_msg_uint8_attr(msg, QDL_DEVLINK_ATTR_PARAM_TYPE, QDL_ATTR_TYPE_UINT32);
-		_qdl_put_msg_dynamic_attr(msg, QDL_DEVLINK_ATTR_PARAM_VALUE_DATA,
-					  &((qdl_msg_param_set_t*)data)->minsrev_value,
+		_qdl_put_msg_dynamic_attr(msg, QDL_DEVLINK_ATTR_PARAM_VALUE_DATA, (uint8_t*)&param_set->minsrev_value,
 					  sizeof(uint32_t));
 		break;
 	case QDL_CMD_REGION_GET:
-		if(data == NULL || _qdl_validate_region_name(((qdl_region_t*)data)->name) != QDL_SUCCESS) {
-			free(msg);
-			return NULL;
-		}
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_REGION_NAME, ((qdl_region_t*)data)->name);
+		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_REGION_NAME, region->name);
 		break;
 	case QDL_CMD_REGION_NEW:
 	case QDL_CMD_REGION_DEL:
-		if(data == NULL || _qdl_validate_region_name(((qdl_region_t*)data)->name) != QDL_SUCCESS) {
-			free(msg);
-			return NULL;
-		}
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_REGION_NAME, ((qdl_region_t*)data)->name);
-		_qdl_put_msg_uint32_attr(msg, QDL_DEVLINK_ATTR_REGION_SNAPSHOT_ID,
-				         ((qdl_region_t*)data)->snapshot_id);
+		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_REGION_NAME, region->name);
+		_qdl_put_msg_uint32_attr(msg, QDL_DEVLINK_ATTR_REGION_SNAPSHOT_ID, region->snapshot_id);
 		break;
 	case QDL_CMD_REGION_READ:
-		if(data == NULL ||
-		   _qdl_validate_region_name(((qdl_msg_region_read_t*)data)->region) != QDL_SUCCESS) {
-			free(msg);
-			return NULL;
-		}
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_REGION_NAME,
-				      ((qdl_msg_region_read_t*)data)->region);
+		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_REGION_NAME, region_read->region);
 		_qdl_put_msg_uint32_attr(msg, QDL_DEVLINK_ATTR_REGION_SNAPSHOT_ID,
-					 _qdl_get_snapshot_id(dscr, ((qdl_msg_region_read_t*)data)->region));
-		_qdl_put_msg_uint64_attr(msg, QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR,
-					 ((qdl_msg_region_read_t*)data)->address);
-		_qdl_put_msg_uint64_attr(msg, QDL_DEVLINK_ATTR_REGION_CHUNK_LEN,
-					 ((qdl_msg_region_read_t*)data)->length);
+					 _qdl_get_snapshot_id(dscr, region_read->region));
+		_qdl_put_msg_uint64_attr(msg, QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR, region_read->address);
+		_qdl_put_msg_uint64_attr(msg, QDL_DEVLINK_ATTR_REGION_CHUNK_LEN, region_read->length);
 		break;
 	case QDL_CMD_FLASH_UPDATE:
-		memset(bus_name_buff, 0, sizeof(bus_name_buff));
-		_qdl_put_msg_header(msg, dscr_data->id, NLM_F_REQUEST | NLM_F_ACK);
-		_qdl_put_msg_extra_header(msg, cmd_type, 1);
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_BUS_NAME, "pci");
-		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_LOCATION, _qdl_get_bus_name(dscr, bus_name_buff));
 		_qdl_put_msg_str_attr(msg, QDL_DEVLINK_ATTR_FLASH_UPDATE_FILE_NAME, (char*)data);
 		break;
 	default:
+		break;
+	}
+	*msg_size = ((struct nlmsghdr*)msg)->nlmsg_len;
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * qdl_create_msg
+ * @dscr: QDL descriptor
+ * @cmd_type: command type of message
+ * @msg_size: size of the created message
+ * @data: optional message data dependent on cmd_type
+ *
+ * Allocates buffer for new message of type 'cmd_type' and fills with appropriate content (see
+ * qdl_build_msg()). Notice that user should free the allocated buffer.
+ * Returns address to the created message if success, otherwise NULL.
+ */
+uint8_t* qdl_create_msg(qdl_dscr_t dscr, int cmd_type, unsigned int *msg_size, void* data)
+{
+	qdl_status_t status = QDL_SUCCESS;
+	uint8_t *msg = NULL;
+	int size = 0;
+
+	QDL_DEBUGLOG_ENTERING;
+
+	/* Validate input parameters */
+	if(dscr == NULL || msg_size == NULL) {
+		return NULL;
+	}
+
+	/* Allocate message buffer */
+	size = _qdl_get_msg_size(cmd_type);
+	if(size == 0) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_msg_size", size);
+		return NULL;
+	}
+	msg = malloc(size);
+	if(msg == NULL) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
+		return NULL;
+	}
+
+	status = qdl_build_msg(dscr, cmd_type, data, msg, size, msg_size);
+	if(status != QDL_SUCCESS) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_build_msg", status);
 		free(msg);
-		msg = NULL;
 		*msg_size = 0;
+		return NULL;
 	}
 
 	return msg;
 }
 
+/**
+ * qdl_close_session
+ *
+ * Closes netlink session of the calling thread. Session of other threads is closed when the thread
+ * exits, this function is needed only by the thread which keeps running, e.g. the main one. All
+ * descriptors of the thread must be released before.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t qdl_close_session(void)
+{
+	qdl_session_struct *session = NULL;
+
+	if(qdl_session_key_ready == false) {
+		return QDL_SUCCESS;
+	}
+
+	session = (qdl_session_struct*)pthread_getspecific(qdl_session_key);
+	if(session == NULL) {
+		return QDL_SUCCESS;
+	}
+	if(session->dscr_count > 0) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_close_session", session->dscr_count);
+		return QDL_INVALID_PARAMS;
+	}
+
+	pthread_setspecific(qdl_session_key, NULL);
+	_qdl_free_session(session);
+
+	return QDL_SUCCESS;
+}
+
 /**
  * qdl_release_dev
  * @qdl_dscr: QDL descriptor
  *
- * Releases Devlink resources and closes socket.
+ * Releases Devlink resources and detaches descriptor from the thread session.
  */
 void qdl_release_dev(qdl_dscr_t dscr)
 {
@@ -1048,13 +1826,12 @@ void qdl_release_dev(qdl_dscr_t dscr)
 			}
 		}
 
+		/* Release info snapshot */
+		free(dscr_data->info_snapshot);
+		dscr_data->info_snapshot = NULL;
+
 		/* Release socket */
-		dscr_data->socket = QDL_INVALID_SOCKET;
-		qdl_socket_count--;
-		if(qdl_socket_count == 0) {
-			close(qdl_socket);
-			qdl_socket = QDL_SOCKET_ERROR;
-		}
+		_qdl_detach_session(dscr);
 		free(dscr_data);
 	}
 }
@@ -1067,7 +1844,8 @@ void qdl_release_dev(qdl_dscr_t dscr)
  * @function: PCIe function of the device to initialize
  * @flags: indicates which resources should be initialized
  *
- * Initializes Devlink resources and opens socket to communicate with base driver.
+ * Initializes Devlink resources and attaches descriptor to the netlink session of the calling
+ * thread. Descriptor must be used and released by the same thread.
  * Returns address to the QDL descriptor if the function succeeds, otherwise an error code.
  */
 qdl_dscr_t qdl_init_dev(unsigned int segment, unsigned int bus, unsigned int device, unsigned int function,
@@ -1091,25 +1869,28 @@ qdl_dscr_t qdl_init_dev(unsigned int segment, unsigned int bus, unsigned int dev
 	dscr_data->pci.bus = bus;
 	dscr_data->pci.dev = device;
 	dscr_data->pci.fun = function;
+	_qdl_init_dev_attrs(dscr);
 
 	/* Initialize others descriptor fields */
 	dscr_data->flash_region.snapshot_id = QDL_INVALID_SNAPSHOT_ID;
 	dscr_data->flash_region.new_snapshot_id = false;
 	dscr_data->caps_region.snapshot_id = QDL_INVALID_SNAPSHOT_ID;
 	dscr_data->caps_region.new_snapshot_id = false;
+	dscr_data->flash_region.deferred = false;
+	dscr_data->caps_region.deferred = false;
 
-	/* Open socket for Devlink */
-	status = _qdl_open_socket(dscr);
+	/* Attach to the netlink session of the calling thread */
+	status = _qdl_attach_session(dscr);
 	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_open_socket", status);
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_attach_session", status);
 		qdl_release_dev(dscr);
 		return NULL;
 	}
 
-	/* Read message type */
-	status = _qdl_read_msg_family_id(dscr, &dscr_data->id);
+	/* Get message type - cached for the process */
+	status = _qdl_get_family_id(dscr, &dscr_data->id);
 	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_read_msg_family_id", status);
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_get_family_id", status);
 		qdl_release_dev(dscr);
 		return NULL;
 	}
@@ -1153,7 +1934,7 @@ qdl_status_t qdl_init_region(qdl_dscr_t dscr, qdl_region_t* region, bool free_re
 	uint8_t *msg = NULL;
 	qdl_status_t status = QDL_SUCCESS;
 	uint32_t snapshot_id = 0;
-	unsigned int rec_buff_size = QDL_REC_BUFF_SIZE;
+	unsigned int rec_buff_size = 0;
 	unsigned int msg_size = 0;
 
 	QDL_DEBUGLOG_ENTERING;
@@ -1162,16 +1943,9 @@ qdl_status_t qdl_init_region(qdl_dscr_t dscr, qdl_region_t* region, bool free_re
 	memset(&del_region, 0, sizeof(del_region));
 
 	/* Check if snapshot is created */
-	rec_buff = malloc(rec_buff_size);
-	if(rec_buff == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
-		return QDL_MEMORY_ERROR;
-	}
-	memset(rec_buff, 0, rec_buff_size);
-	status = qdl_receive_reply_msg(dscr, QDL_CMD_REGION_GET, region, rec_buff, &rec_buff_size);
+	status = _qdl_receive_pooled_reply_msg(dscr, QDL_CMD_REGION_GET, region, &rec_buff, &rec_buff_size);
 	if(status != QDL_SUCCESS) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_receive_reply_msg", status);
-		free(rec_buff);
+		QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_receive_pooled_reply_msg", status);
 		return status;
 	}
 
@@ -1190,12 +1964,10 @@ qdl_status_t qdl_init_region(qdl_dscr_t dscr, qdl_region_t* region, bool free_re
 			status = _qdl_del_region(dscr, &del_region);
 			if(status != QDL_SUCCESS) {
 				QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_del_region", status);
-				free(rec_buff);
 				return status;
 			}
 		}
 	}
-	free(rec_buff);
 
 	/* Create new snapshot */
 	if(strcmp(region->name, QDL_REGION_NAME_FLASH) == 0) {
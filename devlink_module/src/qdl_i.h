@@ -33,19 +33,38 @@ qdl_status_t qdl_get_string_by_type(qdl_dscr_t dscr, uint8_t *buff, uint32_t buf
 				    char *string, unsigned int string_size);
 qdl_status_t qdl_get_string_by_key(qdl_dscr_t dscr, uint8_t *buff, uint32_t buff_size, char *name,
 				   char *value, int value_size);
+qdl_status_t qdl_get_msg_string_by_key(uint8_t *msg, unsigned int msg_size, char *key, char *value,
+				      int value_size);
+qdl_status_t qdl_dump_dev_info(qdl_dev_msg_callback_t callback, void *context);
+qdl_status_t qdl_index_msg(uint8_t *msg, unsigned int msg_size, qdl_msg_index_t *index);
+qdl_status_t qdl_index_dev_msg(qdl_dscr_t dscr, uint8_t *buff, uint32_t buff_size, qdl_msg_index_t *index);
+qdl_status_t qdl_get_indexed_string_by_key(qdl_msg_index_t *index, char *key, char *value, int value_size);
+qdl_status_t qdl_get_info_snapshot(qdl_dscr_t dscr, uint8_t **buff, unsigned int *buff_size);
 uint32_t qdl_get_region_header_size(uint32_t data_size);
 qdl_status_t qdl_read_region(qdl_dscr_t dscr, uint8_t *msg_buff, uint32_t msg_buff_size, uint64_t offset,
 			     uint8_t *bin_buff, unsigned int *bin_size);
+qdl_status_t qdl_get_region_size(qdl_dscr_t dscr, char *region_name, uint64_t *size);
+qdl_status_t qdl_read_region_stream(qdl_dscr_t dscr, char *region_name, uint64_t address, uint64_t length,
+				    qdl_region_chunk_callback_t callback, void *context);
 qdl_status_t qdl_get_param_value(qdl_dscr_t dscr, uint8_t *buff, uint32_t buff_size, char *name,
 				 qdl_param_cmode_t cmode, uint8_t *data, unsigned int *data_size);
 qdl_status_t qdl_send_msg(qdl_dscr_t dscr, uint8_t *msg, unsigned int msg_size);
 qdl_status_t qdl_receive_msg(qdl_dscr_t dscr, uint8_t *msg, unsigned int *msg_size);
 qdl_status_t qdl_receive_reply_msg(qdl_dscr_t dscr, int cmd_type, void *data, uint8_t *reply_buff,
 				   unsigned int *reply_buff_size);
+qdl_status_t qdl_build_msg(qdl_dscr_t dscr, int cmd_type, void *data, uint8_t *msg, unsigned int msg_buff_size,
+			   unsigned int *msg_size);
 uint8_t* qdl_create_msg(qdl_dscr_t dscr, int cmd_type, unsigned int *msg_size, void* data);
 void qdl_release_dev(qdl_dscr_t qdl_dscr);
+qdl_status_t qdl_close_session(void);
 qdl_dscr_t qdl_init_dev(unsigned int segment, unsigned int bus, unsigned int device, unsigned int function,
 			unsigned int flags);
 qdl_status_t qdl_init_region(qdl_dscr_t dscr, qdl_region_t* region, bool free_resources);
+unsigned int qdl_read_pci_config_space(unsigned int segment, unsigned int bus, unsigned int device,
+				       unsigned int function, qdl_pci_config_space_t *config_space);
+qdl_status_t qdl_get_pci_net_interface(unsigned int segment, unsigned int bus, unsigned int device,
+				       unsigned int function, char *buff, unsigned int buff_size);
+void qdl_enable_pci_net_map(bool enable);
+void qdl_release_pci_cache(void);
 
 #endif /* QDL_I_H_ */
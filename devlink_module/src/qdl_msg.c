@@ -35,7 +35,6 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-#define QDL_DEVLINK_NAME  "devlink"
 
 /*
  * Devlink message
@@ -67,6 +66,15 @@ typedef struct {
 	qdl_attr_type_t type;
 } qdl_attr_field_t;
 
+/* Destination of region chunks copied by _qdl_get_region() */
+typedef struct {
+	uint8_t *buff;
+	unsigned int buff_size;
+	unsigned int read_data;
+	uint64_t *init_offset;
+	bool first_chunk_read;
+} qdl_region_copy_t;
+
 static qdl_attr_field_t qdl_ctrl_attr_table[] = {
 	{CTRL_ATTR_FAMILY_ID,                       QDL_ATTR_TYPE_UINT16},
 	{CTRL_ATTR_FAMILY_NAME,                     QDL_ATTR_TYPE_STRING},
@@ -153,64 +161,36 @@ qdl_status_t _qdl_validate_region_name(char* name)
  * _qdl_get_msg_size
  * @cmd_type: command type for the message
  *
- * Returns message size.
+ * Returns upper bound of the message size. Bounds are compile-time constants (see QDL_MSG_SIZE_*).
  */
 int _qdl_get_msg_size(int cmd_type)
 {
-	int size = 0;
-	int header_size = sizeof(struct nlmsghdr);
-	int extra_header_size = sizeof(struct genlmsghdr);
-	int str_attr_header_size = NLA_HDRLEN;
-
 	switch(cmd_type) {
 	case QDL_CMD_GET:
 	case QDL_CMD_INFO_GET:
-		size = header_size + extra_header_size + 2 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH;
-		break;
+		return QDL_MSG_SIZE_INFO_GET;
 	case QDL_CMD_PORT_GET:
-		size = header_size + extra_header_size;
-		break;
+		return QDL_MSG_SIZE_PORT_GET;
 	case QDL_CMD_RELOAD:
-		size = header_size + extra_header_size + 3 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-			   QDL_PCI_LOCATION_NAME_LENGTH + NLA_ALIGN(sizeof(uint8_t));
-		break;
+		return QDL_MSG_SIZE_RELOAD;
 	case QDL_CMD_PARAM_GET:
-		size = header_size + extra_header_size + 3 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH + NLA_ALIGN(strlen(QDL_FW_SREV_NAME) + 1);
-		break;
+		return QDL_MSG_SIZE_PARAM_GET;
 	case QDL_CMD_PARAM_SET:
-		size = header_size + extra_header_size + 6 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH + NLA_ALIGN(strlen(QDL_FW_SREV_NAME) + 1) + \
-		       2 * NLA_ALIGN(sizeof(uint8_t)) + NLA_ALIGN(sizeof(uint32_t));
-		break;
+		return QDL_MSG_SIZE_PARAM_SET;
 	case QDL_CMD_REGION_GET:
-		size = header_size + extra_header_size + 3 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH + NLA_ALIGN(QDL_REGION_NAME_SIZE);
-		break;
+		return QDL_MSG_SIZE_REGION_GET;
 	case QDL_CMD_REGION_NEW:
 	case QDL_CMD_REGION_DEL:
-		size = header_size + extra_header_size + 4 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH + NLA_ALIGN(QDL_REGION_NAME_SIZE) + sizeof(uint32_t);
-		break;
+		return QDL_MSG_SIZE_REGION_NEW;
 	case QDL_CMD_REGION_READ:
-		size = header_size + extra_header_size + 6 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH + NLA_ALIGN(QDL_REGION_NAME_SIZE) + sizeof(uint32_t) + \
-		       2 * sizeof(uint64_t);
-		break;
+		return QDL_MSG_SIZE_REGION_READ;
 	case QDL_CMD_FLASH_UPDATE:
-		size = header_size + extra_header_size + 3 * str_attr_header_size + QDL_BUS_NAME_LENGTH + \
-		       QDL_PCI_LOCATION_NAME_LENGTH + QDL_FILE_NAME_MAX_LENGTH;
-		break;
+		return QDL_MSG_SIZE_FLASH_UPDATE;
 	case CTRL_CMD_GETFAMILY:
-		size = header_size + extra_header_size + str_attr_header_size + \
-		       NLA_ALIGN(strlen(QDL_DEVLINK_NAME) + 1);
-		break;
+		return QDL_MSG_SIZE_GETFAMILY;
 	default:
-		size = 0;
+		return 0;
 	}
-
-	return size;
 }
 
 /**
@@ -727,6 +707,177 @@ uint8_t* _qdl_get_nattr_value_addr_by_type(uint8_t *msg, uint32_t msg_size, uint
 	return NULL;
 }
 
+/**
+ * _qdl_get_key_hash
+ * @key: key string
+ *
+ * Returns FNV-1a hash of the key string.
+ */
+uint32_t _qdl_get_key_hash(char *key)
+{
+	uint32_t hash = 2166136261u;
+
+	while(*key != '\0') {
+		hash ^= (uint8_t)*key++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * _qdl_get_attr_string
+ * @msg: message buffer
+ * @msg_size: message size
+ * @attr_addr: attribute address
+ *
+ * Returns attribute data as a string if it is null terminated within the attribute, otherwise NULL.
+ */
+char* _qdl_get_attr_string(uint8_t *msg, uint32_t msg_size, uint8_t *attr_addr)
+{
+	struct nlattr *attr = (struct nlattr*)attr_addr;
+	uint8_t *data = NULL;
+
+	data = _qdl_get_attr_data_addr(msg, msg_size, attr_addr);
+	if(data == NULL || attr->nla_len <= NLA_HDRLEN) {
+		return NULL;
+	}
+	if(memchr(data, '\0', attr->nla_len - NLA_HDRLEN) == NULL) {
+		return NULL;
+	}
+
+	return (char*)data;
+}
+
+/**
+ * _qdl_add_index_key
+ * @index: message index
+ * @key: key string
+ * @value: value attribute address
+ *
+ * Adds key to the hash of the message index. The first value of the key is kept, as the linear
+ * search returned it.
+ */
+void _qdl_add_index_key(qdl_msg_index_t *index, char *key, uint8_t *value)
+{
+	uint32_t slot = 0;
+	uint32_t i = 0;
+
+	slot = _qdl_get_key_hash(key) & (QDL_MSG_INDEX_KEYS - 1);
+	for(i = 0; i < QDL_MSG_INDEX_KEYS; i++) {
+		if(index->keys[slot].key == NULL) {
+			index->keys[slot].key = key;
+			index->keys[slot].value = value;
+			return;
+		}
+		if(strcmp(index->keys[slot].key, key) == 0) {
+			return;
+		}
+		slot = (slot + 1) & (QDL_MSG_INDEX_KEYS - 1);
+	}
+	index->keys_overflow = true;
+}
+
+/**
+ * _qdl_build_msg_index
+ * @msg: message buffer
+ * @msg_size: message size
+ * @index: message index to build
+ *
+ * Walks the message once and records key/value pairs of nested attributes (as found by
+ * _qdl_get_nattr_value_addr_by_key()). Worth it only if several keys are looked up in the message.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t _qdl_build_msg_index(uint8_t *msg, uint32_t msg_size, qdl_msg_index_t *index)
+{
+	struct nlmsghdr *header = (struct nlmsghdr*)msg;
+	struct nlattr *attr = NULL;
+	struct nlattr *nattr = NULL;
+	char *key = NULL;
+
+	if(msg == NULL || index == NULL) {
+		return QDL_INVALID_PARAMS;
+	}
+
+	memset(index, 0, sizeof(*index));
+	index->msg = msg;
+	index->msg_size = msg_size;
+
+	attr = (struct nlattr*)_qdl_get_first_attr_addr(msg, msg_size);
+	while(attr != NULL) {
+		if(_qdl_is_nattr(attr, header->nlmsg_type)) {
+			/* First child of the nested attribute may be a key for the second one */
+			nattr = (struct nlattr*)_qdl_get_next_nattr_addr((uint8_t*)attr, NULL);
+			key = _qdl_get_attr_string(msg, msg_size, (uint8_t*)nattr);
+			if(key != NULL) {
+				_qdl_add_index_key(index, key, _qdl_get_next_nattr_addr((uint8_t*)attr, (uint8_t*)nattr));
+			}
+		}
+
+		attr = (struct nlattr*)_qdl_get_next_attr_addr(msg, msg_size, (uint8_t*)attr);
+	}
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * _qdl_get_indexed_nattr_value_addr_by_key
+ * @index: message index
+ * @key: key string for nested attribute
+ *
+ * Returns address for the nested attribute based on nested attribute name if it is present,
+ * otherwise NULL.
+ */
+uint8_t* _qdl_get_indexed_nattr_value_addr_by_key(qdl_msg_index_t *index, char *key)
+{
+	uint32_t slot = 0;
+	uint32_t i = 0;
+
+	slot = _qdl_get_key_hash(key) & (QDL_MSG_INDEX_KEYS - 1);
+	for(i = 0; i < QDL_MSG_INDEX_KEYS; i++) {
+		if(index->keys[slot].key == NULL) {
+			break;
+		}
+		if(strcmp(index->keys[slot].key, key) == 0) {
+			return index->keys[slot].value;
+		}
+		slot = (slot + 1) & (QDL_MSG_INDEX_KEYS - 1);
+	}
+
+	/* Key could be dropped only if the hash is full */
+	if(index->keys_overflow) {
+		return _qdl_get_nattr_value_addr_by_key(index->msg, index->msg_size, key);
+	}
+
+	return NULL;
+}
+
+/**
+ * _qdl_get_indexed_string_nattr_by_key
+ * @index: message index
+ * key: name of the child key attribute
+ * @value: buffer for a value of the nested attribute
+ * @value_size: buffer size of the value
+ *
+ * Works like _qdl_get_string_nattr_by_key() for indexed message.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t _qdl_get_indexed_string_nattr_by_key(qdl_msg_index_t *index, char *key, char *value,
+		unsigned int value_size)
+{
+	uint8_t *attr_addr = NULL;
+	uint8_t *data = NULL;
+
+	attr_addr = _qdl_get_indexed_nattr_value_addr_by_key(index, key);
+	data = _qdl_get_attr_data_addr(index->msg, index->msg_size, attr_addr);
+	if(data != NULL) {
+		strncpy(value, (char*)data, value_size);
+		return QDL_SUCCESS;
+	}
+
+	return QDL_PARSE_MSG_ERROR;
+}
+
 /**
  * _qdl_get_uint32_attr
  * @msg: message buffer
@@ -752,6 +903,32 @@ qdl_status_t _qdl_get_uint32_attr(uint8_t *msg, uint32_t msg_size, uint32_t type
 	return QDL_PARSE_MSG_ERROR;
 }
 
+/**
+ * _qdl_get_uint64_attr
+ * @msg: message buffer
+ * @msg_size: buffer size
+ * @type: attribute type
+ * @value: uint64 value for attribute of type 'type'
+ *
+ * Gets attribute data as uint64 value based on argument 'type'. Attribute data is only 4-byte
+ * aligned in the message, so the value is copied.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t _qdl_get_uint64_attr(uint8_t *msg, uint32_t msg_size, uint32_t type, uint64_t *value)
+{
+	uint8_t *attr_addr = NULL;
+	uint8_t *data = NULL;
+
+	attr_addr = _qdl_get_attr_addr(msg, msg_size, type);
+	data = _qdl_get_attr_data_addr(msg, msg_size, attr_addr);
+	if(data != NULL) {
+		memcpy(value, data, sizeof(*value));
+		return QDL_SUCCESS;
+	}
+
+	return QDL_PARSE_MSG_ERROR;
+}
+
 /**
  * _qdl_get_string_attr
  * @msg: message buffer
@@ -864,29 +1041,21 @@ qdl_status_t _qdl_get_int_nattr_by_type(uint8_t *msg, uint32_t msg_size, uint32_
 }
 
 /**
- * _qdl_get_region
- * @msg: buffer with messages
+ * _qdl_walk_region_chunks
+ * @msg: region read message
  * @msg_size: buffer size
- * @bin_buff: buffer for read NVM
- * @bin_size: buffer size and on exit size of the read binary data
- * @init_offset: initial offset of read flash
+ * @next_address: address expected for the first chunk (QDL_REGION_ADDRESS_ANY accepts any),
+ *                on exit address following the last chunk
+ * @callback: function called for every chunk
+ * @context: user data passed to the callback
  *
- * Collects all binary buffer attributes from message and copies them to bin_buff parameter. Function checks
- * if collected data is continuous. If not QDL_CORRUPTED_MSG_ERROR error is returned. The attribute structure
- * for NVM buffer is as follows:
- * - QDL_DEVLINK_ATTR_REGION_CHUNKS <nested>
- *   -> QDL_DEVLINK_ATTR_REGION_CHUNK <nested>
- *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_DATA <binary> # 1st data chunk of the max size 0x100 bytes
- *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR <uint64> # starting address for the 1st chunk
- *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_DATA <binary> # 2nd data chunk of the max size 0x100 bytes
- *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR <uint64> # starting address for the 2nd chunk
- *      ...
- *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_DATA <binary> # last data chunk of the remaining size
- *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR <uint64> # starting address for the last chunk
+ * Walks QDL_DEVLINK_ATTR_REGION_CHUNK attributes of the message (see _qdl_get_region() for the
+ * structure) and passes data of every chunk to the callback without copying. Chunks have to be
+ * continuous, otherwise QDL_CORRUPTED_MSG_ERROR is returned. Walk stops on the first callback error.
  * Returns QDL_SUCCESS if success, otherwise error code.
  */
-qdl_status_t _qdl_get_region(uint8_t *msg, uint32_t msg_size, uint8_t *bin_buff, unsigned int *bin_size,
-			     uint64_t *init_offset)
+qdl_status_t _qdl_walk_region_chunks(uint8_t *msg, uint32_t msg_size, uint64_t *next_address,
+				     qdl_region_chunk_callback_t callback, void *context)
 {
 	uint8_t *chunks_addr = NULL;
 	uint8_t *chunk_addr = NULL;
@@ -896,8 +1065,6 @@ qdl_status_t _qdl_get_region(uint8_t *msg, uint32_t msg_size, uint8_t *bin_buff,
 	uint64_t *read_offset = NULL;
 	qdl_status_t status = QDL_SUCCESS;
 	unsigned int chunk_size = 0;
-	unsigned int read_data = 0;
-	bool first_chunk = true;
 
 	/* Find nested attribute QDL_DEVLINK_ATTR_REGION_CHUNKS */
 	chunks_addr = _qdl_get_attr_addr(msg, msg_size, QDL_DEVLINK_ATTR_REGION_CHUNKS);
@@ -905,7 +1072,6 @@ qdl_status_t _qdl_get_region(uint8_t *msg, uint32_t msg_size, uint8_t *bin_buff,
 		return QDL_PARSE_MSG_ERROR;
 	}
 
-	/* Find QDL_DEVLINK_ATTR_REGION_CHUNK attribute with appropriate offset */
 	chunk_addr = _qdl_get_next_nattr_addr_by_type(chunks_addr, QDL_DEVLINK_ATTR_REGION_CHUNK, NULL);
 	while(chunk_addr != NULL) {
 		offset_addr = _qdl_get_next_nattr_addr_by_type(chunk_addr, QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR,
@@ -914,55 +1080,110 @@ qdl_status_t _qdl_get_region(uint8_t *msg, uint32_t msg_size, uint8_t *bin_buff,
 			return QDL_PARSE_MSG_ERROR;
 		}
 
-		/* Compare chunk data offset with the one requested */
+		/* Compare chunk data offset with the expected one */
 		read_offset = (uint64_t*)_qdl_get_attr_data_addr(msg, msg_size, offset_addr);
 		if(read_offset == NULL) {
 			return QDL_PARSE_MSG_ERROR;
 		}
-		if(first_chunk) {
-			*init_offset = *read_offset;
-			first_chunk = false;
+		if(*next_address != QDL_REGION_ADDRESS_ANY && *read_offset != *next_address) {
+			return QDL_CORRUPTED_MSG_ERROR;
 		}
-		if(*read_offset == *init_offset + read_data) {
-			/* Find attribute QDL_DEVLINK_ATTR_REGION_CHUNK_DATA */
-			data_addr = _qdl_get_next_nattr_addr_by_type(chunk_addr,
-								     QDL_DEVLINK_ATTR_REGION_CHUNK_DATA,
-								     NULL);
-			if(data_addr == NULL) {
-				return QDL_PARSE_MSG_ERROR;
-			}
 
-			/* Copy binary data if buffer size is correct */
-			chunk_size = ((struct nlattr*)data_addr)->nla_len - NLA_HDRLEN;
-			if(chunk_size > *bin_size - read_data) {
-				chunk_size = *bin_size - read_data;
-				status = QDL_BUFFER_TOO_SMALL_ERROR;
-			}
-			data = (uint8_t*)_qdl_get_attr_data_addr(msg, msg_size, data_addr);
-			if(data == NULL) {
-				return QDL_PARSE_MSG_ERROR;
-			}
-			memcpy((bin_buff + read_data), data, chunk_size);
-			read_data += chunk_size;
+		/* Find attribute QDL_DEVLINK_ATTR_REGION_CHUNK_DATA */
+		data_addr = _qdl_get_next_nattr_addr_by_type(chunk_addr, QDL_DEVLINK_ATTR_REGION_CHUNK_DATA, NULL);
+		if(data_addr == NULL) {
+			return QDL_PARSE_MSG_ERROR;
+		}
+		data = (uint8_t*)_qdl_get_attr_data_addr(msg, msg_size, data_addr);
+		if(data == NULL) {
+			return QDL_PARSE_MSG_ERROR;
+		}
+		chunk_size = ((struct nlattr*)data_addr)->nla_len - NLA_HDRLEN;
 
-			/* Check if any error occurred */
-			if(status != QDL_SUCCESS) {
-				*bin_size = read_data;
-				return status;
-			}
-		} else {
-			return QDL_CORRUPTED_MSG_ERROR;
+		status = callback(*read_offset, data, chunk_size, context);
+		if(status != QDL_SUCCESS) {
+			return status;
 		}
+		*next_address = *read_offset + chunk_size;
 
 		chunk_addr = _qdl_get_next_nattr_addr_by_type(chunks_addr, QDL_DEVLINK_ATTR_REGION_CHUNK,
 							      chunk_addr);
 	}
 
-	*bin_size = read_data;
-
 	return QDL_SUCCESS;
 }
 
+/**
+ * _qdl_copy_region_chunk
+ * @address: chunk address
+ * @data: chunk data
+ * @data_size: chunk size
+ * @context: qdl_region_copy_t describing the destination buffer
+ *
+ * Region chunk callback used by _qdl_get_region() - copies chunk to the buffer.
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t _qdl_copy_region_chunk(uint64_t address, uint8_t *data, unsigned int data_size, void *context)
+{
+	qdl_region_copy_t *copy = (qdl_region_copy_t*)context;
+	qdl_status_t status = QDL_SUCCESS;
+
+	if(copy->first_chunk_read == false) {
+		*copy->init_offset = address;
+		copy->first_chunk_read = true;
+	}
+
+	/* Copy binary data if buffer size is correct */
+	if(data_size > copy->buff_size - copy->read_data) {
+		data_size = copy->buff_size - copy->read_data;
+		status = QDL_BUFFER_TOO_SMALL_ERROR;
+	}
+	memcpy(copy->buff + copy->read_data, data, data_size);
+	copy->read_data += data_size;
+
+	return status;
+}
+
+/**
+ * _qdl_get_region
+ * @msg: buffer with messages
+ * @msg_size: buffer size
+ * @bin_buff: buffer for read NVM
+ * @bin_size: buffer size and on exit size of the read binary data
+ * @init_offset: initial offset of read flash
+ *
+ * Collects all binary buffer attributes from message and copies them to bin_buff parameter. Function checks
+ * if collected data is continuous. If not QDL_CORRUPTED_MSG_ERROR error is returned. The attribute structure
+ * for NVM buffer is as follows:
+ * - QDL_DEVLINK_ATTR_REGION_CHUNKS <nested>
+ *   -> QDL_DEVLINK_ATTR_REGION_CHUNK <nested>
+ *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_DATA <binary> # 1st data chunk of the max size 0x100 bytes
+ *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR <uint64> # starting address for the 1st chunk
+ *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_DATA <binary> # 2nd data chunk of the max size 0x100 bytes
+ *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR <uint64> # starting address for the 2nd chunk
+ *      ...
+ *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_DATA <binary> # last data chunk of the remaining size
+ *      -> QDL_DEVLINK_ATTR_REGION_CHUNK_ADDR <uint64> # starting address for the last chunk
+ * Returns QDL_SUCCESS if success, otherwise error code.
+ */
+qdl_status_t _qdl_get_region(uint8_t *msg, uint32_t msg_size, uint8_t *bin_buff, unsigned int *bin_size,
+			     uint64_t *init_offset)
+{
+	qdl_region_copy_t copy;
+	qdl_status_t status = QDL_SUCCESS;
+	uint64_t next_address = QDL_REGION_ADDRESS_ANY;
+
+	memset(&copy, 0, sizeof(copy));
+	copy.buff = bin_buff;
+	copy.buff_size = *bin_size;
+	copy.init_offset = init_offset;
+
+	status = _qdl_walk_region_chunks(msg, msg_size, &next_address, _qdl_copy_region_chunk, &copy);
+	*bin_size = copy.read_data;
+
+	return status;
+}
+
 /**
  * _qdl_get_param_value
  * @msg: message buffer
@@ -1043,6 +1264,54 @@ qdl_status_t _qdl_get_param_value(uint8_t *msg, uint32_t msg_size, uint8_t cmode
 	return status;
 }
 
+/**
+ * _qdl_encode_attr
+ * @buff: buffer for the attribute
+ * @type: attribute type
+ * @value: attribute value
+ * @size: value size
+ *
+ * Writes attribute header, value and zeroed padding to the buffer, so the buffer does not need to be
+ * cleared before.
+ * Returns size of the attribute including padding.
+ */
+uint32_t _qdl_encode_attr(uint8_t *buff, uint16_t type, void *value, uint32_t size)
+{
+	struct nlattr *attr = (struct nlattr*)buff;
+	uint32_t length = NLA_HDRLEN + size;
+
+	attr->nla_len = length;
+	attr->nla_type = type;
+	memcpy(buff + NLA_HDRLEN, value, size);
+	memset(buff + length, 0, NLA_ALIGN(length) - length);
+
+	return NLA_ALIGN(length);
+}
+
+/**
+ * _qdl_put_msg_attrs
+ * @msg: message buffer
+ * @attrs: encoded attributes
+ * @size: size of encoded attributes
+ *
+ * Appends attributes encoded earlier by _qdl_encode_attr() to the message with one copy.
+ * Returns pointer to the message buffer if success, otherwise NULL.
+ */
+uint8_t* _qdl_put_msg_attrs(uint8_t *msg, uint8_t *attrs, uint32_t size)
+{
+	struct nlmsghdr *header = (struct nlmsghdr*)msg;
+
+	/* Validate parameters */
+	if(header == NULL || attrs == NULL) {
+		return NULL;
+	}
+
+	memcpy(_qdl_get_msg_tail(msg), attrs, size);
+	header->nlmsg_len += size;
+
+	return msg;
+}
+
 /**
  * _qdl_put_msg_str_attr
  * @msg: message buffer
@@ -1055,20 +1324,13 @@ qdl_status_t _qdl_get_param_value(uint8_t *msg, uint32_t msg_size, uint8_t cmode
 uint8_t* _qdl_put_msg_str_attr(uint8_t *msg, uint16_t type, char *string)
 {
 	struct nlmsghdr *header = (struct nlmsghdr*)msg;
-	struct nlattr *attr = (struct nlattr*)_qdl_get_msg_tail(msg);
-	uint8_t *data = (uint8_t*)attr + NLA_HDRLEN;
-	int length = NLA_ALIGN(strlen(string) + 1) + NLA_HDRLEN;
 
 	/* Validate parameters */
-	if(attr == NULL || header == NULL) {
+	if(header == NULL || string == NULL) {
 		return NULL;
 	}
 
-	/* Fill attribute buffer */
-	attr->nla_len = length;
-	attr->nla_type = type;
-	memcpy(data, string, strlen(string) + 1);
-	header->nlmsg_len += length;
+	header->nlmsg_len += _qdl_encode_attr(_qdl_get_msg_tail(msg), type, string, strlen(string) + 1);
 
 	return msg;
 }
@@ -1084,23 +1346,7 @@ uint8_t* _qdl_put_msg_str_attr(uint8_t *msg, uint16_t type, char *string)
  */
 uint8_t* _qdl_put_msg_uint8_attr(uint8_t *msg, uint16_t type, uint8_t value)
 {
-	struct nlmsghdr *header = (struct nlmsghdr*)msg;
-	struct nlattr *attr = (struct nlattr*)_qdl_get_msg_tail(msg);
-	uint8_t *data = (uint8_t*)attr + NLA_HDRLEN;
-	int length = sizeof(value) + NLA_HDRLEN;
-
-	/* Validate parameters */
-	if(attr == NULL || header == NULL) {
-		return NULL;
-	}
-
-	/* Fill attribute buffer */
-	attr->nla_len = length;
-	attr->nla_type = type;
-	memcpy(data, &value, sizeof(value));
-	header->nlmsg_len += NLA_ALIGN(length);
-
-	return msg;
+	return _qdl_put_msg_dynamic_attr(msg, type, &value, sizeof(value));
 }
 
 /**
@@ -1114,23 +1360,7 @@ uint8_t* _qdl_put_msg_uint8_attr(uint8_t *msg, uint16_t type, uint8_t value)
  */
 uint8_t* _qdl_put_msg_uint32_attr(uint8_t *msg, uint16_t type, uint32_t value)
 {
-	struct nlmsghdr *header = (struct nlmsghdr*)msg;
-	struct nlattr *attr = (struct nlattr*)_qdl_get_msg_tail(msg);
-	uint8_t *data = (uint8_t*)attr + NLA_HDRLEN;
-	int length = NLA_ALIGN(sizeof(value)) + NLA_HDRLEN;
-
-	/* Validate parameters */
-	if(attr == NULL || header == NULL) {
-		return NULL;
-	}
-
-	/* Fill attribute buffer */
-	attr->nla_len = length;
-	attr->nla_type = type;
-	memcpy(data, &value, sizeof(value));
-	header->nlmsg_len += length;
-
-	return msg;
+	return _qdl_put_msg_dynamic_attr(msg, type, (uint8_t*)&value, sizeof(value));
 }
 
 /**
@@ -1144,23 +1374,7 @@ uint8_t* _qdl_put_msg_uint32_attr(uint8_t *msg, uint16_t type, uint32_t value)
  */
 uint8_t* _qdl_put_msg_uint64_attr(uint8_t *msg, uint16_t type, uint64_t value)
 {
-	struct nlmsghdr *header = (struct nlmsghdr*)msg;
-	struct nlattr *attr = (struct nlattr*)_qdl_get_msg_tail(msg);
-	uint8_t *data = (uint8_t*)attr + NLA_HDRLEN;
-	int length = NLA_ALIGN(sizeof(value)) + NLA_HDRLEN;
-
-	/* Validate parameters */
-	if(attr == NULL || header == NULL) {
-		return NULL;
-	}
-
-	/* Fill attribute buffer */
-	attr->nla_len = length;
-	attr->nla_type = type;
-	memcpy(data, &value, sizeof(value));
-	header->nlmsg_len += length;
-
-	return msg;
+	return _qdl_put_msg_dynamic_attr(msg, type, (uint8_t*)&value, sizeof(value));
 }
 
 /**
@@ -1176,20 +1390,13 @@ uint8_t* _qdl_put_msg_uint64_attr(uint8_t *msg, uint16_t type, uint64_t value)
 uint8_t* _qdl_put_msg_dynamic_attr(uint8_t *msg, uint16_t type, uint8_t *value, uint32_t size)
 {
 	struct nlmsghdr *header = (struct nlmsghdr*)msg;
-	struct nlattr *attr = (struct nlattr*)_qdl_get_msg_tail(msg);
-	uint8_t *data = (uint8_t*)attr + NLA_HDRLEN;
-	int length = NLA_ALIGN(size) + NLA_HDRLEN;
 
 	/* Validate parameters */
-	if(attr == NULL || header == NULL || value == NULL || size == 0) {
+	if(header == NULL || value == NULL || size == 0) {
 		return NULL;
 	}
 
-	/* Fill attribute buffer */
-	attr->nla_len = length;
-	attr->nla_type = type;
-	memcpy(data, value, size);
-	header->nlmsg_len += length;
+	header->nlmsg_len += _qdl_encode_attr(_qdl_get_msg_tail(msg), type, value, size);
 
 	return msg;
 }
@@ -1216,6 +1423,7 @@ uint8_t* _qdl_put_msg_extra_header(uint8_t *msg, uint8_t cmd, uint8_t version)
 	/* Fill extra header */
 	extra_header->cmd = cmd;
 	extra_header->version = version;
+	extra_header->reserved = 0;
 	header->nlmsg_len += NLA_ALIGN(sizeof(*extra_header));
 
 	return msg;
@@ -1250,29 +1458,26 @@ uint8_t* _qdl_put_msg_header(uint8_t *msg, uint16_t type, uint16_t flags)
 }
 
 /**
- * _qdl_create_generic_msg
+ * _qdl_build_generic_msg
  * @id: message ID
  * @cmd_type: command type of message
- * @msg_size: size of the created message
+ * @msg: buffer for the message
+ * @msg_buff_size: buffer size
+ * @msg_size: size of the built message
  *
- * Allocates buffer for message of the type 'cmd_type' and fills with appropriate content.
- * Returns address to the created message if success, otherwise NULL.
+ * Builds message of the type 'cmd_type' in the provided buffer.
+ * Returns QDL_SUCCESS if success, otherwise error code.
  */
-uint8_t* _qdl_create_generic_msg(int id, int cmd_type, unsigned int *msg_size)
+qdl_status_t _qdl_build_generic_msg(int id, int cmd_type, uint8_t *msg, unsigned int msg_buff_size,
+				    unsigned int *msg_size)
 {
-	uint8_t *msg = NULL;
-
-	*msg_size = _qdl_get_msg_size(cmd_type);
-	if(*msg_size == 0) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("qdl_get_msg_size", (int)*msg_size);
-		return NULL;
+	if(msg == NULL || msg_size == NULL) {
+		return QDL_INVALID_PARAMS;
 	}
-	msg = malloc(*msg_size);
-	if(msg == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("malloc", 0);
-		return NULL;
+	if(msg_buff_size < (unsigned int)_qdl_get_msg_size(cmd_type)) {
+		return QDL_BUFFER_TOO_SMALL_ERROR;
 	}
-	memset(msg, 0, *msg_size);
+
 	switch(cmd_type) {
 	case CTRL_CMD_GETFAMILY:
 		_qdl_put_msg_header(msg, id, NLM_F_REQUEST | NLM_F_ACK);
@@ -1280,12 +1485,11 @@ uint8_t* _qdl_create_generic_msg(int id, int cmd_type, unsigned int *msg_size)
 		_qdl_put_msg_str_attr(msg, CTRL_ATTR_FAMILY_NAME, QDL_DEVLINK_NAME);
 		break;
 	default:
-		free(msg);
-		msg = NULL;
-		*msg_size = 0;
+		return QDL_INVALID_PARAMS;
 	}
+	*msg_size = ((struct nlmsghdr*)msg)->nlmsg_len;
 
-	return msg;
+	return QDL_SUCCESS;
 }
 
 /**
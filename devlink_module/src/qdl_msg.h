@@ -28,25 +28,32 @@
 
 #include "qdl_t.h"
 
-#define QDL_REGION_NAME_FLASH  "nvm-flash"
-#define QDL_REGION_NAME_CAPS   "device-caps"
-#define QDL_REGION_NAME_SIZE   12                /* Max length of the region name */
+#define QDL_REGION_ADDRESS_ANY 0xFFFFFFFFFFFFFFFFULL  /* Any address accepted for the first chunk */
 
 bool _qdl_is_ctrl_msg(struct nlmsghdr *msg);
 uint8_t* _qdl_get_msg_data_addr(uint8_t *msg);
 qdl_status_t _qdl_validate_region_name(char* name);
 int _qdl_get_msg_size(int cmd_type);
 uint8_t* _qdl_get_next_msg(uint8_t *buff, unsigned int buff_size, uint8_t *msg);
+qdl_status_t _qdl_build_msg_index(uint8_t *msg, uint32_t msg_size, qdl_msg_index_t *index);
+uint8_t* _qdl_get_indexed_nattr_value_addr_by_key(qdl_msg_index_t *index, char *key);
+qdl_status_t _qdl_get_indexed_string_nattr_by_key(qdl_msg_index_t *index, char *key, char *value,
+		unsigned int value_size);
 qdl_status_t _qdl_get_uint32_attr(uint8_t *msg, uint32_t msg_size, uint32_t type, uint32_t *value);
+qdl_status_t _qdl_get_uint64_attr(uint8_t *msg, uint32_t msg_size, uint32_t type, uint64_t *value);
 qdl_status_t _qdl_get_string_attr(uint8_t *msg, uint32_t msg_size, uint32_t type, char *string,
 		unsigned int string_size);
 qdl_status_t _qdl_get_string_nattr_by_key(uint8_t *msg, uint32_t msg_size, char *name, char *value,
 		unsigned int value_size);
 qdl_status_t _qdl_get_int_nattr_by_type(uint8_t *msg, uint32_t msg_size, uint32_t type, uint32_t *value);
+qdl_status_t _qdl_walk_region_chunks(uint8_t *msg, uint32_t msg_size, uint64_t *next_address,
+				     qdl_region_chunk_callback_t callback, void *context);
 qdl_status_t _qdl_get_region(uint8_t *msg, uint32_t msg_size, uint8_t *bin_buff, unsigned int *bin_size,
 			     uint64_t *init_offset);
 qdl_status_t _qdl_get_param_value(uint8_t *msg, uint32_t msg_size, uint8_t cmode, uint8_t *data,
 				  unsigned int *data_size);
+uint32_t _qdl_encode_attr(uint8_t *buff, uint16_t type, void *value, uint32_t size);
+uint8_t* _qdl_put_msg_attrs(uint8_t *msg, uint8_t *attrs, uint32_t size);
 uint8_t* _qdl_put_msg_extra_header(uint8_t *msg, uint8_t cmd, uint8_t version);
 uint8_t* _qdl_put_msg_header(uint8_t *msg, uint16_t type, uint16_t flags);
 uint8_t* _qdl_put_msg_str_attr(uint8_t *msg, uint16_t type, char *string);
@@ -54,7 +61,8 @@ uint8_t* _qdl_put_msg_uint8_attr(uint8_t *msg, uint16_t type, uint8_t value);
 uint8_t* _qdl_put_msg_uint32_attr(uint8_t *msg, uint16_t type, uint32_t value);
 uint8_t* _qdl_put_msg_uint64_attr(uint8_t *msg, uint16_t type, uint64_t value);
 uint8_t* _qdl_put_msg_dynamic_attr(uint8_t *msg, uint16_t type, uint8_t *value, uint32_t size);
-uint8_t* _qdl_create_generic_msg(int id, int cmd_type, unsigned int *msg_size);
+qdl_status_t _qdl_build_generic_msg(int id, int cmd_type, uint8_t *msg, unsigned int msg_buff_size,
+				    unsigned int *msg_size);
 void _qdl_print_msg(FILE *fp, uint8_t *buff, uint32_t buff_size);
 
 #endif /* _QDL_MSG_H_ */
@@ -26,12 +26,90 @@
 #include "qdl_debug.h"
 #include "qdl_codes.h"
 #include "qdl_t.h"
+#include "qdl_i.h"
 #include <dirent.h>
 #include <errno.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/rtnetlink.h>
 
 #define QDL_PCI_RESOURCES_DIR        "/sys/bus/pci/devices/"
+#define QDL_PCI_CACHE_BUCKETS        64
+#define QDL_PCI_NET_DIR              "/sys/class/net/"
+#define QDL_LINK_DUMP_BUFF_SIZE      32768
+#define QDL_NET_MAP_INITIAL_SIZE     32
+#define QDL_PCI_BUS_NAME             "pci"
+
+/* Parent device attributes, available since Linux 5.15 */
+#ifndef IFLA_PARENT_DEV_NAME
+#define IFLA_PARENT_DEV_NAME         56
+#define IFLA_PARENT_DEV_BUS_NAME     57
+#endif
+#define QDL_PCI_CACHE_KEY(seg, bus, dev, fun) \
+	(((uint32_t)(seg) << 16) | (((bus) & 0xFF) << 8) | (((dev) & 0x1F) << 3) | ((fun) & 0x7))
+
+typedef struct qdl_pci_cache_entry {
+	uint32_t key;
+	unsigned int size;
+	qdl_pci_config_space_t config_space;
+	struct qdl_pci_cache_entry *next;
+} qdl_pci_cache_entry_t;
+
+typedef struct {
+	uint32_t key;
+	unsigned int order;                                   /* position in the link dump */
+	char name[IF_NAMESIZE];
+} qdl_net_map_entry_t;
+
+static qdl_pci_cache_entry_t *qdl_pci_cache[QDL_PCI_CACHE_BUCKETS];
+static pthread_mutex_t qdl_pci_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* BDF->ifname map sorted by key, built with one link dump. The dump is attempted once per run and
+ * only if the map is enabled - without it the net directory of each device is read. */
+static qdl_net_map_entry_t *qdl_net_map = NULL;
+static unsigned int qdl_net_map_size = 0;
+static unsigned int qdl_net_map_capacity = 0;
+static bool qdl_net_map_ready = false;
+static bool qdl_net_map_attempted = false;
+static bool qdl_net_map_enabled = true;
+
+/**
+ * _qdl_read_pci_file
+ * @file_name: full path to sysfs file
+ * @buff: buffer for file content
+ * @buff_size: buffer size
+ *
+ * Reads up to 'buff_size' bytes from the beginning of the file using as few read calls as possible.
+ * Returns number of read bytes.
+ */
+unsigned int _qdl_read_pci_file(char *file_name, uint8_t *buff, unsigned int buff_size)
+{
+	unsigned int read_bytes = 0;
+	ssize_t return_value = 0;
+	int fd = -1;
+
+	fd = open(file_name, O_RDONLY);
+	if(fd < 0) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("open", errno);
+		return read_bytes;
+	}
+	while(read_bytes < buff_size) {
+		return_value = pread(fd, buff + read_bytes, buff_size - read_bytes, read_bytes);
+		if(return_value <= 0) {
+			break;
+		}
+		read_bytes += return_value;
+	}
+	close(fd);
+
+	return read_bytes;
+}
 
 /**
  * _qdl_get_pci_net_interface
@@ -44,16 +122,35 @@
  */
 qdl_status_t _qdl_get_pci_net_interface(qdl_dscr_t dscr, char *buff, unsigned int buff_size)
 {
-	char dir_name[QDL_FILE_NAME_MAX_LENGTH] = {'\0'};
 	qdl_struct *dscr_data = (qdl_struct*)dscr;
+
+	return qdl_get_pci_net_interface(dscr_data->pci.seg, dscr_data->pci.bus, dscr_data->pci.dev,
+					 dscr_data->pci.fun, buff, buff_size);
+}
+
+/**
+ * _qdl_read_pci_net_dir
+ * @segment: PCI segment
+ * @bus: PCI bus
+ * @device: PCI device
+ * @function: PCI function
+ * @buff: buffer for net interface name
+ * @buff_size: buffer size
+ *
+ * Gets net interface name reading the net directory of the device. Used when the link dump is not available.
+ * Returns QDL_SUCCESS if success, otherwise an error code (QDL_NO_PCI_RESOURCES).
+ */
+qdl_status_t _qdl_read_pci_net_dir(unsigned int segment, unsigned int bus, unsigned int device,
+				   unsigned int function, char *buff, unsigned int buff_size)
+{
+	char dir_name[QDL_FILE_NAME_MAX_LENGTH] = {'\0'};
 	DIR *dir = NULL;
 	struct dirent *dir_entry = NULL;
 	qdl_status_t status = QDL_NO_PCI_RESOURCES;
 	unsigned int length = 0;
 
 	/* File name to access VPD data */
-	sprintf(dir_name, "%s%04x:%02x:%02x.%x/net", QDL_PCI_RESOURCES_DIR, dscr_data->pci.seg,
-		dscr_data->pci.bus, dscr_data->pci.dev, dscr_data->pci.fun);
+	sprintf(dir_name, "%s%04x:%02x:%02x.%x/net", QDL_PCI_RESOURCES_DIR, segment, bus, device, function);
 
 	/* Open dir with PCI net resources */
 	dir = opendir(dir_name);
@@ -79,6 +176,327 @@ qdl_status_t _qdl_get_pci_net_interface(qdl_dscr_t dscr, char *buff, unsigned in
 	return status;
 }
 
+/**
+ * _qdl_add_net_map_entry
+ * @name: net interface name
+ * @bus_name: parent device bus name (NULL if not provided by kernel)
+ * @dev_name: parent device name (NULL if not provided by kernel)
+ *
+ * Adds net interface to the BDF->ifname map. If the kernel doesn't report the parent device, it is resolved
+ * from the /sys/class/net/<if>/device link. Duplicates are removed once the dump is complete.
+ * Returns QDL_SUCCESS if success, otherwise an error code.
+ */
+qdl_status_t _qdl_add_net_map_entry(char *name, char *bus_name, char *dev_name)
+{
+	char link_name[QDL_FILE_NAME_MAX_LENGTH] = {'\0'};
+	char link[QDL_FILE_NAME_MAX_LENGTH] = {'\0'};
+	qdl_net_map_entry_t *map = NULL;
+	unsigned int seg = 0, bus = 0, dev = 0, fun = 0;
+	unsigned int capacity = 0;
+	uint32_t key = 0;
+	ssize_t link_size = 0;
+
+	if(bus_name == NULL || dev_name == NULL) {
+		/* old kernel - read parent device from sysfs */
+		sprintf(link_name, "%s%.*s/device", QDL_PCI_NET_DIR, IF_NAMESIZE, name);
+		link_size = readlink(link_name, link, sizeof(link) - 1);
+		if(link_size <= 0) {
+			return QDL_SUCCESS; /* virtual interface */
+		}
+		dev_name = strrchr(link, '/');
+		dev_name = (dev_name == NULL) ? link : dev_name + 1;
+	} else if(strcmp(bus_name, QDL_PCI_BUS_NAME) != 0) {
+		return QDL_SUCCESS;
+	}
+
+	if(sscanf(dev_name, "%x:%x:%x.%x", &seg, &bus, &dev, &fun) != 4) {
+		return QDL_SUCCESS;
+	}
+	key = QDL_PCI_CACHE_KEY(seg, bus, dev, fun);
+
+	/* the map grows geometrically, so the whole dump is stored in amortized O(n) */
+	if(qdl_net_map_size == qdl_net_map_capacity) {
+		capacity = (qdl_net_map_capacity == 0) ? QDL_NET_MAP_INITIAL_SIZE : qdl_net_map_capacity * 2;
+		map = realloc(qdl_net_map, capacity * sizeof(qdl_net_map_entry_t));
+		if(map == NULL) {
+			return QDL_MEMORY_ERROR;
+		}
+		qdl_net_map = map;
+		qdl_net_map_capacity = capacity;
+	}
+	qdl_net_map[qdl_net_map_size].key = key;
+	qdl_net_map[qdl_net_map_size].order = qdl_net_map_size;
+	strncpy(qdl_net_map[qdl_net_map_size].name, name, IF_NAMESIZE - 1);
+	qdl_net_map[qdl_net_map_size].name[IF_NAMESIZE - 1] = '\0';
+	qdl_net_map_size++;
+
+	return QDL_SUCCESS;
+}
+
+/**
+ * _qdl_compare_net_map_entry
+ * @first: map entry
+ * @second: map entry
+ *
+ * Orders map entries by PCI location, entries of the same PCI function by their position in the dump.
+ * Returns negative, zero or positive value as qsort() and bsearch() expect.
+ */
+int _qdl_compare_net_map_entry(const void *first, const void *second)
+{
+	const qdl_net_map_entry_t *a = (const qdl_net_map_entry_t*)first;
+	const qdl_net_map_entry_t *b = (const qdl_net_map_entry_t*)second;
+
+	if(a->key != b->key) {
+		return (a->key < b->key) ? -1 : 1;
+	}
+
+	return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+
+/**
+ * _qdl_compare_net_map_key
+ * @key: PCI location key
+ * @entry: map entry
+ *
+ * Compares PCI location key with map entry for bsearch().
+ * Returns negative, zero or positive value.
+ */
+int _qdl_compare_net_map_key(const void *key, const void *entry)
+{
+	uint32_t a = *(const uint32_t*)key;
+	uint32_t b = ((const qdl_net_map_entry_t*)entry)->key;
+
+	return (a < b) ? -1 : (a > b);
+}
+
+/**
+ * _qdl_sort_net_map
+ *
+ * Sorts the map by PCI location and keeps only the first interface of each PCI function.
+ */
+void _qdl_sort_net_map(void)
+{
+	unsigned int i = 0;
+	unsigned int size = 0;
+
+	qsort(qdl_net_map, qdl_net_map_size, sizeof(qdl_net_map_entry_t), _qdl_compare_net_map_entry);
+
+	for(i = 0; i < qdl_net_map_size; i++) {
+		if(size > 0 && qdl_net_map[size - 1].key == qdl_net_map[i].key) {
+			continue;
+		}
+		qdl_net_map[size++] = qdl_net_map[i];
+	}
+	qdl_net_map_size = size;
+}
+
+/**
+ * _qdl_free_net_map
+ *
+ * Releases the map entries. Must be called with qdl_pci_cache_lock held.
+ */
+void _qdl_free_net_map(void)
+{
+	free(qdl_net_map);
+	qdl_net_map = NULL;
+	qdl_net_map_size = 0;
+	qdl_net_map_capacity = 0;
+	qdl_net_map_ready = false;
+}
+
+/**
+ * _qdl_parse_link_msg
+ * @nlh: RTM_NEWLINK message
+ *
+ * Reads interface name and parent device from link message and adds it to the map.
+ * Returns QDL_SUCCESS if success, otherwise an error code.
+ */
+qdl_status_t _qdl_parse_link_msg(struct nlmsghdr *nlh)
+{
+	struct ifinfomsg *ifm = (struct ifinfomsg*)NLMSG_DATA(nlh);
+	struct rtattr *rta = IFLA_RTA(ifm);
+	int rta_len = IFLA_PAYLOAD(nlh);
+	char *name = NULL;
+	char *bus_name = NULL;
+	char *dev_name = NULL;
+
+	for(; RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+		switch(rta->rta_type) {
+		case IFLA_IFNAME:
+			name = (char*)RTA_DATA(rta);
+			break;
+		case IFLA_PARENT_DEV_NAME:
+			dev_name = (char*)RTA_DATA(rta);
+			break;
+		case IFLA_PARENT_DEV_BUS_NAME:
+			bus_name = (char*)RTA_DATA(rta);
+			break;
+		default:
+			break;
+		}
+	}
+	if(name == NULL) {
+		return QDL_SUCCESS;
+	}
+
+	return _qdl_add_net_map_entry(name, bus_name, dev_name);
+}
+
+/**
+ * _qdl_build_net_map
+ *
+ * Builds BDF->ifname map with a single RTM_GETLINK dump. The map is sorted once the dump is complete.
+ * Returns QDL_SUCCESS if success, otherwise an error code.
+ */
+qdl_status_t _qdl_build_net_map(void)
+{
+	struct {
+		struct nlmsghdr nlh;
+		struct ifinfomsg ifm;
+	} req;
+	struct nlmsghdr *nlh = NULL;
+	uint8_t *buff = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+	ssize_t rec_size = 0;
+	bool done = false;
+	int fd = -1;
+
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	req.nlh.nlmsg_type = RTM_GETLINK;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	req.nlh.nlmsg_seq = 1;
+	req.ifm.ifi_family = AF_UNSPEC;
+
+	fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if(fd < 0) {
+		QDL_DEBUGLOG_FUNCTION_FAIL("socket", errno);
+		return QDL_OPEN_SOCKET_ERROR;
+	}
+
+	do {
+		buff = malloc(QDL_LINK_DUMP_BUFF_SIZE);
+		if(buff == NULL) {
+			status = QDL_MEMORY_ERROR;
+			break;
+		}
+
+		if(send(fd, &req, req.nlh.nlmsg_len, 0) < 0) {
+			QDL_DEBUGLOG_FUNCTION_FAIL("send", errno);
+			status = QDL_SEND_MSG_ERROR;
+			break;
+		}
+
+		while(done == false && status == QDL_SUCCESS) {
+			rec_size = recv(fd, buff, QDL_LINK_DUMP_BUFF_SIZE, 0);
+			if(rec_size <= 0) {
+				QDL_DEBUGLOG_FUNCTION_FAIL("recv", errno);
+				status = QDL_RECEIVE_MSG_ERROR;
+				break;
+			}
+
+			for(nlh = (struct nlmsghdr*)buff; NLMSG_OK(nlh, (unsigned int)rec_size);
+			    nlh = NLMSG_NEXT(nlh, rec_size)) {
+				if(nlh->nlmsg_type == NLMSG_DONE) {
+					done = true;
+					break;
+				}
+				if(nlh->nlmsg_type == NLMSG_ERROR) {
+					status = QDL_RECEIVE_MSG_ERROR;
+					break;
+				}
+				if(nlh->nlmsg_type == RTM_NEWLINK) {
+					status = _qdl_parse_link_msg(nlh);
+					if(status != QDL_SUCCESS) {
+						break;
+					}
+				}
+			}
+		}
+	} while(0);
+
+	free(buff);
+	close(fd);
+
+	if(status == QDL_SUCCESS) {
+		_qdl_sort_net_map();
+	}
+
+	return status;
+}
+
+/**
+ * qdl_enable_pci_net_map
+ * @enable: build the BDF->ifname map on first lookup
+ *
+ * Enables or disables the BDF->ifname map. Disable it when only a single device is looked up - reading
+ * the net directory of one device is cheaper than a link dump of the whole host.
+ */
+void qdl_enable_pci_net_map(bool enable)
+{
+	pthread_mutex_lock(&qdl_pci_cache_lock);
+	qdl_net_map_enabled = enable;
+	pthread_mutex_unlock(&qdl_pci_cache_lock);
+}
+
+/**
+ * qdl_get_pci_net_interface
+ * @segment: PCI segment
+ * @bus: PCI bus
+ * @device: PCI device
+ * @function: PCI function
+ * @buff: buffer for net interface name
+ * @buff_size: buffer size
+ *
+ * Gets net interface name for specified device. The BDF->ifname map is built with one rtnetlink link dump
+ * on first call; if the map is disabled or the dump fails the net directory of the device is read. A failed
+ * dump is not repeated.
+ * Returns QDL_SUCCESS if success, otherwise an error code (QDL_NO_PCI_RESOURCES).
+ */
+qdl_status_t qdl_get_pci_net_interface(unsigned int segment, unsigned int bus, unsigned int device,
+				       unsigned int function, char *buff, unsigned int buff_size)
+{
+	uint32_t key = QDL_PCI_CACHE_KEY(segment, bus, device, function);
+	qdl_net_map_entry_t *entry = NULL;
+	qdl_status_t status = QDL_SUCCESS;
+	bool map_ready = false;
+
+	if(buff == NULL || buff_size == 0) {
+		QDL_DEBUGLOG_ERROR_MSG("Invalid parameter");
+		return QDL_INVALID_PARAMS;
+	}
+
+	pthread_mutex_lock(&qdl_pci_cache_lock);
+	if(qdl_net_map_enabled == true && qdl_net_map_attempted == false) {
+		qdl_net_map_attempted = true;
+		status = _qdl_build_net_map();
+		if(status == QDL_SUCCESS) {
+			qdl_net_map_ready = true;
+		} else {
+			QDL_DEBUGLOG_FUNCTION_FAIL("_qdl_build_net_map", status);
+			_qdl_free_net_map();
+		}
+	}
+	map_ready = qdl_net_map_ready;
+
+	status = QDL_NO_PCI_RESOURCES;
+	if(map_ready == true) {
+		entry = bsearch(&key, qdl_net_map, qdl_net_map_size, sizeof(qdl_net_map_entry_t),
+				_qdl_compare_net_map_key);
+		if(entry != NULL && strlen(entry->name) < buff_size) {
+			strncpy(buff, entry->name, buff_size);
+			status = QDL_SUCCESS;
+		}
+	}
+	pthread_mutex_unlock(&qdl_pci_cache_lock);
+
+	if(map_ready == false) {
+		status = _qdl_read_pci_net_dir(segment, bus, device, function, buff, buff_size);
+	}
+
+	return status;
+}
+
 /**
  * _qdl_read_pci_config_space
  * @dscr: QDL descriptor
@@ -93,46 +511,27 @@ unsigned int _qdl_read_pci_resources(qdl_dscr_t dscr, char *resources, uint8_t *
 {
 	char file_name[QDL_FILE_NAME_MAX_LENGTH] = { 0 };
 	qdl_struct *dscr_data = (qdl_struct*)dscr;
-	FILE *fp = NULL;
-	int return_value = 0;
-	unsigned int i = 0;
-	unsigned int read_bytes = 0;
 
 	/* File name to access PCI resources */
 	sprintf(file_name, "%s%04x:%02x:%02x.%x/%s", QDL_PCI_RESOURCES_DIR, dscr_data->pci.seg,
 		dscr_data->pci.bus, dscr_data->pci.dev, dscr_data->pci.fun, resources);
 
-	/* Read PCI resources */
-	fp = fopen(file_name, "r");
-	if(fp == NULL) {
-		QDL_DEBUGLOG_FUNCTION_FAIL("fopen", errno);
-		return read_bytes;
-	}
-	for(i = 0; i < buff_size; i++) {
-		return_value = fread(&buff[i], 1, 1, fp);
-		if(return_value != 1) {
-			break;
-		}
-	}
-	read_bytes = i;
-	fclose(fp);
-
-	return read_bytes;
+	return _qdl_read_pci_file(file_name, buff, buff_size);
 }
 
 /**
  * _qdl_read_pci_config_space
  * @qdl_dscr: QDL descriptor
  *
- * Reads PCI Config Space data for specified device.
+ * Reads PCI Config Space data for specified device. The data is taken from the config space cache.
  * Returns number of read bytes.
  */
 unsigned int _qdl_read_pci_config_space(qdl_dscr_t dscr)
 {
 	qdl_struct *dscr_data = (qdl_struct*)dscr;
 
-	return _qdl_read_pci_resources(dscr, "config", (uint8_t*)&dscr_data->pci.config_space,
-				       sizeof(qdl_pci_config_space_t));
+	return qdl_read_pci_config_space(dscr_data->pci.seg, dscr_data->pci.bus, dscr_data->pci.dev,
+					 dscr_data->pci.fun, &dscr_data->pci.config_space);
 }
 
 /**
@@ -168,3 +567,89 @@ unsigned int _qdl_read_pci_mac_addr(qdl_dscr_t dscr, char *mac_buff, unsigned in
 
 	return _qdl_read_pci_resources(dscr, addr_string, (uint8_t*)mac_buff, mac_buff_size);
 }
+
+/**
+ * qdl_read_pci_config_space
+ * @segment: PCI segment
+ * @bus: PCI bus
+ * @device: PCI device
+ * @function: PCI function
+ * @config_space: buffer for PCI config space header
+ *
+ * Reads PCI config space header for specified device. The header is read with a single pread() call
+ * on first access and kept in a per-BDF cache for the lifetime of the process.
+ * Returns number of read bytes (0 if config space is not available).
+ */
+unsigned int qdl_read_pci_config_space(unsigned int segment, unsigned int bus, unsigned int device,
+				       unsigned int function, qdl_pci_config_space_t *config_space)
+{
+	char file_name[QDL_FILE_NAME_MAX_LENGTH] = { 0 };
+	uint32_t key = QDL_PCI_CACHE_KEY(segment, bus, device, function);
+	qdl_pci_cache_entry_t *entry = NULL;
+	unsigned int read_bytes = 0;
+
+	if(config_space == NULL) {
+		QDL_DEBUGLOG_ERROR_MSG("Invalid parameter");
+		return read_bytes;
+	}
+
+	pthread_mutex_lock(&qdl_pci_cache_lock);
+	for(entry = qdl_pci_cache[key % QDL_PCI_CACHE_BUCKETS]; entry != NULL; entry = entry->next) {
+		if(entry->key == key) {
+			memcpy(config_space, &entry->config_space, sizeof(qdl_pci_config_space_t));
+			read_bytes = entry->size;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&qdl_pci_cache_lock);
+	if(entry != NULL) {
+		return read_bytes;
+	}
+
+	sprintf(file_name, "%s%04x:%02x:%02x.%x/config", QDL_PCI_RESOURCES_DIR, segment, bus, device, function);
+	memset(config_space, 0, sizeof(qdl_pci_config_space_t));
+	read_bytes = _qdl_read_pci_file(file_name, (uint8_t*)config_space, sizeof(qdl_pci_config_space_t));
+	if(read_bytes == 0) {
+		return read_bytes;
+	}
+
+	entry = calloc(1, sizeof(qdl_pci_cache_entry_t));
+	if(entry == NULL) {
+		/* data is valid even if it cannot be cached */
+		return read_bytes;
+	}
+	entry->key = key;
+	entry->size = read_bytes;
+	memcpy(&entry->config_space, config_space, sizeof(qdl_pci_config_space_t));
+
+	pthread_mutex_lock(&qdl_pci_cache_lock);
+	entry->next = qdl_pci_cache[key % QDL_PCI_CACHE_BUCKETS];
+	qdl_pci_cache[key % QDL_PCI_CACHE_BUCKETS] = entry;
+	pthread_mutex_unlock(&qdl_pci_cache_lock);
+
+	return read_bytes;
+}
+
+/**
+ * qdl_release_pci_cache
+ *
+ * Releases all entries of the PCI config space cache and the net interface map.
+ */
+void qdl_release_pci_cache(void)
+{
+	qdl_pci_cache_entry_t *entry = NULL;
+	qdl_pci_cache_entry_t *next = NULL;
+	unsigned int i = 0;
+
+	pthread_mutex_lock(&qdl_pci_cache_lock);
+	for(i = 0; i < QDL_PCI_CACHE_BUCKETS; i++) {
+		for(entry = qdl_pci_cache[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			free(entry);
+		}
+		qdl_pci_cache[i] = NULL;
+	}
+	_qdl_free_net_map();
+	qdl_net_map_attempted = false;
+	pthread_mutex_unlock(&qdl_pci_cache_lock);
+}
@@ -26,6 +26,7 @@
 #ifndef QDL_T_H_
 #define QDL_T_H_
 
+#include <linux/genetlink.h>
 #include <linux/netlink.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -34,6 +35,12 @@
 #define QDL_INIT_NET_INTERFACE           (1 << 0)
 #define QDL_INIT_NVM                     (1 << 1)
 #define QDL_INIT_CAPS                    (1 << 2)
+#define QDL_INIT_INFO_ONLY               (1 << 3)  /* Defer NVM/CAPS region setup until first region read */
+
+/* Region names */
+#define QDL_REGION_NAME_FLASH            "nvm-flash"
+#define QDL_REGION_NAME_CAPS             "device-caps"
+#define QDL_REGION_NAME_SIZE             12        /* Max length of the region name */
 
 /* Message const */
 #define QDL_REC_BUFF_SIZE                8192L   /* Buffer size for received message */
@@ -58,6 +65,28 @@
 #define QDL_FW_SREV_NAME                 "fw.mgmt.minsrev"
 #define QDL_OROM_SREV_NAME               "fw.undi.minsrev"
 
+/* Compile-time size bounds of request messages built by qdl_build_msg() */
+#define QDL_DEVLINK_NAME                 "devlink"
+#define QDL_BUS_NAME_PCI                 "pci"
+#define QDL_MSG_ATTR_SIZE(size)          (NLA_HDRLEN + NLA_ALIGN(size))
+#define QDL_MSG_HEADERS_SIZE             (NLMSG_ALIGN(sizeof(struct nlmsghdr)) + NLA_ALIGN(sizeof(struct genlmsghdr)))
+#define QDL_MSG_DEV_ATTRS_SIZE           (QDL_MSG_ATTR_SIZE(sizeof(QDL_BUS_NAME_PCI)) + \
+					  QDL_MSG_ATTR_SIZE(QDL_PCI_LOCATION_NAME_LENGTH))
+#define QDL_MSG_DEV_HEADERS_SIZE         (QDL_MSG_HEADERS_SIZE + QDL_MSG_DEV_ATTRS_SIZE)
+
+#define QDL_MSG_SIZE_GETFAMILY           (QDL_MSG_HEADERS_SIZE + QDL_MSG_ATTR_SIZE(sizeof(QDL_DEVLINK_NAME)))
+#define QDL_MSG_SIZE_PORT_GET            QDL_MSG_HEADERS_SIZE
+#define QDL_MSG_SIZE_INFO_GET            QDL_MSG_DEV_HEADERS_SIZE
+#define QDL_MSG_SIZE_RELOAD              (QDL_MSG_DEV_HEADERS_SIZE + QDL_MSG_ATTR_SIZE(sizeof(uint8_t)))
+#define QDL_MSG_SIZE_PARAM_GET           (QDL_MSG_DEV_HEADERS_SIZE + QDL_MSG_ATTR_SIZE(QDL_PARAM_NAME_SIZE))
+#define QDL_MSG_SIZE_PARAM_SET           (QDL_MSG_SIZE_PARAM_GET + 2 * QDL_MSG_ATTR_SIZE(sizeof(uint8_t)) + \
+					  QDL_MSG_ATTR_SIZE(sizeof(uint32_t)))
+#define QDL_MSG_SIZE_REGION_GET          (QDL_MSG_DEV_HEADERS_SIZE + QDL_MSG_ATTR_SIZE(QDL_REGION_NAME_SIZE))
+#define QDL_MSG_SIZE_REGION_NEW          (QDL_MSG_SIZE_REGION_GET + QDL_MSG_ATTR_SIZE(sizeof(uint32_t)))
+#define QDL_MSG_SIZE_REGION_READ         (QDL_MSG_SIZE_REGION_NEW + 2 * QDL_MSG_ATTR_SIZE(sizeof(uint64_t)))
+#define QDL_MSG_SIZE_FLASH_UPDATE        (QDL_MSG_DEV_HEADERS_SIZE + QDL_MSG_ATTR_SIZE(QDL_FILE_NAME_MAX_LENGTH))
+#define QDL_MSG_MAX_SIZE                 QDL_MSG_SIZE_FLASH_UPDATE  /* largest request */
+
 #ifndef bool
 typedef enum {false, true} bool;
 #endif
@@ -106,9 +135,21 @@ typedef struct {
 	char* name;                                           /* Region name */
 	uint32_t snapshot_id;                                 /* Snapshot ID */
 	bool new_snapshot_id;                                 /* did QDL create snapshot ID */
+	bool deferred;                                        /* snapshot is created on first region read */
 } qdl_region_t;
 
+/* Netlink session - every thread owns one, descriptors created by the thread are attached to it */
 typedef struct {
+	int socket;                                           /* socket descriptor */
+	unsigned int dscr_count;                              /* number of attached descriptors */
+	struct sockaddr_nl socket_addr;                       /* socket address */
+	uint8_t *rec_buff;                                    /* reused by all receives */
+	unsigned int rec_buff_size;                           /* receive buffer size */
+	uint32_t send_buff[QDL_MSG_MAX_SIZE / sizeof(uint32_t)]; /* reused by all requests */
+} qdl_session_struct;
+
+typedef struct {
+	qdl_session_struct *session;                          /* attached netlink session */
 	int socket;                                           /* socked descriptor */
 	struct sockaddr_nl socket_addr;                       /* socked address */
 	char net_interface[QDL_DRIVER_NET_INTERFACE_LENGTH];  /* interface name for device */
@@ -116,11 +157,39 @@ typedef struct {
 	qdl_region_t flash_region;                            /* flash region description */
 	qdl_region_t caps_region;                             /* caps region description */
 	qdl_pci_t pci;
+	uint8_t dev_attrs[QDL_MSG_DEV_ATTRS_SIZE];            /* pre-encoded bus name and location attributes */
+	unsigned int dev_attrs_size;                          /* size of pre-encoded attributes */
+	uint8_t *info_snapshot;                               /* INFO_GET reply read by support probe */
+	unsigned int info_snapshot_size;                      /* INFO_GET reply size */
 } qdl_struct;
 
 typedef struct qdl_struct* qdl_dscr_t;
 typedef int qdl_status_t;
 
+/* Called by qdl_read_region_stream() for every region chunk, in address order */
+typedef qdl_status_t (*qdl_region_chunk_callback_t)(uint64_t address, uint8_t *data, unsigned int data_size,
+						    void *context);
+
+/* Message index - key/value nested attributes are walked once and then found without parsing */
+#define QDL_MSG_INDEX_KEYS               64      /* Hash slots for key/value nested attributes, power of 2 */
+
+typedef struct {
+	char *key;                                            /* key string of the nested attribute */
+	uint8_t *value;                                       /* value attribute address */
+} qdl_msg_index_key_t;
+
+typedef struct {
+	uint8_t *msg;                                         /* indexed message */
+	uint32_t msg_size;                                    /* message size */
+	qdl_msg_index_key_t keys[QDL_MSG_INDEX_KEYS];         /* key string -> value attribute */
+	bool keys_overflow;                                   /* not all keys fit into the hash */
+} qdl_msg_index_t;
+
+/* Called by qdl_dump_dev_info() for every device message of the dump reply */
+typedef qdl_status_t (*qdl_dev_msg_callback_t)(unsigned int segment, unsigned int bus, unsigned int device,
+					       unsigned int function, uint8_t *msg, unsigned int msg_size,
+					       void *context);
+
 /* Command ID */
 enum {
 	QDL_CMD_UNKNOWN,
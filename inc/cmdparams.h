@@ -32,6 +32,8 @@
 #define DDP_CMD_LINE_MIN_LONG_PARAMETER_SIZE        3
 #define DDP_CMD_LINE_DOUBLE_DASH_PREFIX_SIZE        2
 
+#define DDP_SELECTOR_SEPARATORS                     ", \t\r\n"
+
 #define CONFLICT_PARAMETERS(a, b) (((static_command_line_parameters) & (a)) && \
                                    ((static_command_line_parameters) & (b))) ? \
                                   TRUE : FALSE
@@ -42,7 +44,13 @@
 bool
 check_command_parameter(uint32_t param);
 
+uint32_t
+get_discovery_thread_count(void);
+
+char*
+get_dump_region(void);
+
 ddp_status_t
-parse_command_line_parameters(int argc, char ** argv, char ** interface_key, char ** file_name, char** input_file_name);
+parse_command_line_parameters(int argc, char ** argv, list_t* selector_list, char ** file_name, char** input_file_name);
 
 #endif
@@ -50,6 +50,7 @@
 #include "ddp_types.h"
 #include "ddp_status.h"
 #include "ddp_list.h"
+#include "ddp_arena.h"
 #include "output.h"
 #include "os.h"
 #include "i40e.h"
@@ -60,6 +61,14 @@
 
 #define PATH_TO_SYSFS_PCI   "/sys/bus/pci/devices/"
 #define PATH_TO_PCI_DRIVERS "/sys/bus/pci/drivers/"
+#define PATH_TO_SYSFS_NET   "/sys/class/net/"
+#define PATH_TO_PCI_IDS     "/usr/share/hwdata/pci.ids"
+
+/* Optional on-disk pci.ids index - used only if the cache directory exists */
+#define PATH_TO_PCI_IDS_INDEX      "/var/cache/ddptool/pci.ids.idx"
+#define PATH_TO_PCI_IDS_INDEX_TEMP "/var/cache/ddptool/pci.ids.idx.XXXXXX"  /* mkstemp() template */
+#define DDP_PCI_IDS_INDEX_MAGIC    0x44445049  /* "DDPI" */
+#define DDP_PCI_IDS_INDEX_VERSION  1
 
 #define ETHTOOL_GDRVINFO 0x00000003
 #define ETHTOOL_IOCTL    0x8946
@@ -85,6 +94,7 @@ typedef struct ifreq ifreq_t;
 #define DDP_DRIVER_NAME_100G_SW           "ice_sw"
 #define DDP_DRIVER_NAME_100G_SWX          "ice_swx"
 
+#define DDP_DRIVER_LINK_IN_DEVICE         "driver"
 #define DDP_PF_DRIVER_LINK_IN_VF_DEVICE   "physfn/driver"
 
 /* String buffer values */
@@ -98,6 +108,11 @@ typedef struct ifreq ifreq_t;
 
 #define PCI_DEVICE_CONFIG_DWORDS          16
 
+/* PCI prefilter - vendor ID and class code are placed in the first 12 bytes of config space */
+#define DDP_PCI_PREFILTER_SIZE            12
+#define DDP_PCI_CLASS_NETWORK             0x02
+#define DDP_PCI_VENDOR_ID_INTEL           0x8086
+
 /* Admin Queue defaults */
 #define I40E_DEFAULT_DESCRIPTORS          32
 #define I40E_ADMINQ_DEFAULT_BUFFER_SIZE   8
@@ -134,6 +149,10 @@ typedef struct ifreq ifreq_t;
 #define DDP_JSON_COMMAND_PARAMETER        'j'
 #define DDP_ALL_ADAPTERS_PARAMETER        'a'
 #define DDP_PARSE_FILE_COMMAND_PARAMETER  'f'
+#define DDP_THREADS_COMMAND_PARAMETER     't'
+#define DDP_SELECTORS_FILE_COMMAND_PARAMETER 0x100  /* long option only */
+#define DDP_DUMP_REGION_COMMAND_PARAMETER    0x101  /* long option only */
+#define DDP_DUMP_FILE_COMMAND_PARAMETER      0x102  /* long option only */
 
 #define DDP_LOCATION_COMMAND_PARAMETER_BIT   (1 << 0)  /* '-s' - location command line parameter */
 #define DDP_ALL_ADAPTERS_PARAMETER_BIT       (1 << 1)  /* '-a' - Show information about all functions supported devices */
@@ -144,6 +163,18 @@ typedef struct ifreq ifreq_t;
 #define DDP_SILENT_MODE_PARAMETER_BIT        (1 << 6)  /* '-l' - silent mode for scripts*/
 #define DDP_JSON_COMMAND_PARAMETER_BIT       (1 << 7)  /* '-j' - JSON file command line parameter */
 #define DDP_PARSE_FILE_COMMAND_PARAMETER_BIT (1 << 8)  /* '-f' - analize binary file */
+#define DDP_THREADS_COMMAND_PARAMETER_BIT    (1 << 9)  /* '-t' - number of discovery worker threads */
+#define DDP_SELECTORS_FILE_COMMAND_PARAMETER_BIT (1 << 10) /* '--selectors-file' - read '-s'/'-i' selectors from file */
+#define DDP_DUMP_REGION_COMMAND_PARAMETER_BIT    (1 << 11) /* '--dump-region' - dump DevLink region of the device */
+#define DDP_DUMP_FILE_COMMAND_PARAMETER_BIT      (1 << 12) /* '--dump-file' - output file for '--dump-region' */
+
+/* Region dump arguments */
+#define DDP_DUMP_REGION_FLASH                "flash"
+#define DDP_DUMP_REGION_CAPS                 "caps"
+
+/* Parallel discovery defaults */
+#define DDP_DEFAULT_DISCOVERY_THREADS        1
+#define DDP_MAX_DISCOVERY_THREADS            32
 
 #define COMPARE_PCI_LOCATION(a, b) ((a)->location.segment) == ((b)->location.segment) ? \
                                     ((a)->location.bus) == ((b)->location.bus) ? TRUE : FALSE : FALSE
@@ -151,6 +182,7 @@ typedef struct ifreq ifreq_t;
 /* Messages dictionary */
 #define EMPTY_MESSAGE  "-"
 #define NO_PROFILE     "No profile loaded"
+#define NOT_FOUND      "Device not found"
 #define UNSUPPORTED_FW "Unsupported FW version"
 
 /* Unused variable */
@@ -184,7 +216,16 @@ write_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, v
 ddp_status_t
 read_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, void* output_register);
 
+ddp_status_t
+write_registers(adapter_t* adapter, uint32_t reg_address, uint32_t dword_count, void* input_registers);
+
+ddp_status_t
+read_registers(adapter_t* adapter, uint32_t reg_address, uint32_t dword_count, void* output_registers);
+
 void
 free_ddp_adapter_list_allocated_fields(list_t* adapter_list);
 
+void
+close_ioctl_transport(adapter_t* adapter);
+
 #endif
@@ -28,6 +28,8 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <pthread.h>
+#include <net/if.h>
 #include <linux/types.h>
 #include "qdl_t.h"
 
@@ -42,6 +44,7 @@
 #define DDP_TRACKID_SIZE                      8
 #define DDP_DEVICE_INDEX_LENGTH               4
 #define DDP_CONNECTION_NAME_NOT_AVAILABLE     "N/A"
+#define DDP_MAX_SELECTOR_LENGTH               64
 
 typedef uint64_t physical_address_t;
 typedef struct   _node_t            node_t;
@@ -61,6 +64,11 @@ typedef struct _driver_os_version_t{
     uint16_t build;
 } driver_os_version_t;
 
+typedef struct _driver_family_t{
+    char*            driver_name;
+    adapter_family_t adapter_family;
+} driver_family_t;
+
 typedef struct _driver_os_context_t{
     driver_os_version_t driver_version;
     bool                driver_available;
@@ -119,6 +127,20 @@ typedef struct _ioctl_structure_t{
     uint8_t  data[1];      /* reserved memory for pointer for buffer */
 } ioctl_structure_t;
 
+/* Base driver ioctl transport - opened on the first ioctl call for the adapter and
+ * reused by all register, admin queue and driver info requests until it is closed.
+ */
+typedef struct _ioctl_transport_t{
+    bool               is_open;
+    int                socket_descriptor;
+    struct ifreq       ifreq;         /* interface name is already resolved (PF name for usable VFs) */
+    ioctl_structure_t* buffer;        /* reusable ioctl buffer */
+    uint32_t           buffer_size;   /* capacity of buffer->data in bytes */
+    uint32_t           number_of_ioctls;
+    int                ioctl_errno;   /* errno of the last ioctl, 0 if it succeeded */
+    bool               bulk_access_unsupported; /* base driver rejected multi-dword register access */
+} ioctl_transport_t;
+
 typedef enum _adminq_error_code_t{
     AQ_EOK          = 0,    /* No Error (success) */
     AQ_EPREM        = 1,    /* Operation not permitted */
@@ -240,8 +262,37 @@ struct _adapter_t{
     char               pf_connection_name[16]; /* the connection name to PF used to read data for VF */
     uint16_t           pf_device_id;
     adapter_family_t   adapter_family;
+    ddp_status_t       selector_status;        /* status of '-s'/'-i' selector which was not resolved in batch mode */
+    ioctl_transport_t  transport;              /* base driver ioctl transport */
 };
 
+/* Per-run arena */
+#define DDP_ARENA_BLOCK_SIZE                  (64 * 1024)
+#define DDP_ARENA_ALIGNMENT                   16
+
+typedef struct _ddp_arena_block_t ddp_arena_block_t;
+
+struct _ddp_arena_block_t{
+    ddp_arena_block_t* next;
+    size_t             size;
+    size_t             used;
+    uint8_t            reserved[8];  /* keeps data aligned to DDP_ARENA_ALIGNMENT */
+    uint8_t            data[];
+};
+
+typedef struct _ddp_arena_statistics_t{
+    uint64_t number_of_allocations;
+    uint64_t allocated_bytes;
+    uint64_t number_of_blocks;       /* heap allocations made by the arena */
+    uint64_t reserved_bytes;
+} ddp_arena_statistics_t;
+
+typedef struct _ddp_arena_t{
+    ddp_arena_block_t*     first_block;
+    pthread_mutex_t        lock;
+    ddp_arena_statistics_t statistics;
+} ddp_arena_t;
+
 typedef struct _node_t{
     void*     data;
     uint32_t  data_size;
@@ -261,12 +312,29 @@ typedef struct _supported_devices_t{
     char*    branding_string;
 } supported_devices_t;
 
+/* Entry of the sorted index over supported devices tables */
+typedef struct _supported_device_index_t{
+    uint64_t             key;             /* VendorID:DeviceID:SubvendorID:SubdeviceID */
+    supported_devices_t* device;
+    adapter_family_t     adapter_family;
+    uint32_t             order;           /* position in the tables - first entry wins for duplicates */
+} supported_device_index_t;
+
+#define DDP_4_PART_ID_KEY(ven, dev, subven, subdev) (((uint64_t)(ven) << 48) | ((uint64_t)(dev) << 32) | \
+                                                     ((uint64_t)(subven) << 16) | (uint64_t)(subdev))
+
 typedef enum _adapter_parameter_t{
     adapter_none,
     adapter_location,
     adapter_interface
 } adapter_parameter_t;
 
+/* Single '-s' or '-i' selector */
+typedef struct _selector_t{
+    adapter_parameter_t type;
+    char                key[DDP_MAX_SELECTOR_LENGTH];
+} selector_t;
+
 /* match levels for collecting branding strings from pci.ids
  * 0 - no match
  * 1 - vendor id matched
@@ -283,6 +351,76 @@ typedef enum _match_level{
     four_part_id_match = 4
 } match_level;
 
+/* Device entry of the pci.ids vendor section index. Names are kept as offsets
+ * into the mapped pci.ids file.
+ */
+typedef struct _pci_ids_device_t{
+    uint16_t device_id;
+    uint16_t reserved;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t first_subsystem;
+    uint32_t number_of_subsystems;
+    uint32_t order;            /* position in pci.ids - first entry wins for duplicates */
+} pci_ids_device_t;
+
+/* Subsystem entry of the pci.ids vendor section index */
+typedef struct _pci_ids_subsystem_t{
+    uint16_t subvendor_id;
+    uint16_t subdevice_id;
+    uint32_t name_offset;
+    uint32_t name_length;
+} pci_ids_subsystem_t;
+
+/* Header of the on-disk pci.ids index, followed by device and subsystem entries.
+ * The index is valid only for the pci.ids file with the same inode, size and mtime.
+ */
+typedef struct _pci_ids_index_header_t{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_device;
+    uint64_t file_inode;
+    uint64_t file_size;
+    int64_t  file_mtime_sec;
+    int64_t  file_mtime_nsec;
+    uint16_t vendor_id;
+    uint16_t vendor_found;
+    uint32_t vendor_name_offset;
+    uint32_t vendor_name_length;
+    uint32_t number_of_devices;
+    uint32_t number_of_subsystems;
+    uint32_t reserved;
+} pci_ids_index_header_t;
+
+/* Memoized result of pci.ids lookup for a single 4-part ID, results are kept sorted by key */
+#define PCI_IDS_MEMO_INITIAL_SIZE 16
+
+typedef struct _pci_ids_memo_t{
+    uint64_t    key;
+    match_level match_level;
+    char*       branding_string;  /* NULL if no match */
+} pci_ids_memo_t;
+
+/* Single entry of the parallel discovery engine. Adapters sharing the PCI location
+ * with the previous usable adapter are not discovered - their profile info is copied
+ * after all workers are joined.
+ */
+typedef struct _discovery_job_t{
+    adapter_t*   adapter;
+    ddp_status_t status;
+    bool         copy_from_previous;
+    bool         is_done;             /* already discovered by the family batch discovery */
+    bool         is_batched;          /* discovered by the family batch, workers skip it */
+} discovery_job_t;
+
+typedef struct _discovery_pool_t{
+    discovery_job_t* jobs;
+    uint32_t         number_of_jobs;
+    uint32_t         next_job;
+    bool             batch_pending;   /* ice batch is not taken by any worker yet */
+    pthread_mutex_t  lock;
+} discovery_pool_t;
+
 /* Types defining specific function pointers for generating output*/
 typedef ddp_status_t (*ddp_output_function_t)(list_t*, ddp_status_value_t, char*);
 
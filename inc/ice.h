@@ -53,6 +53,16 @@
 
 #define ICE_DESC_COOKIE_L_DWORD_OFFSET   3
 
+/* CSR adminQ completion poller - HICR is polled without sleeping for a few reads, then
+ * with exponentially growing sleeps until the deadline. Deadline may be overridden at build time.
+ */
+#ifndef ICE_CSR_POLL_DEADLINE_US
+#define ICE_CSR_POLL_DEADLINE_US         3000000 /* 3 s */
+#endif
+#define ICE_CSR_POLL_SPIN_COUNT          8
+#define ICE_CSR_POLL_MIN_BACKOFF_US      2
+#define ICE_CSR_POLL_MAX_BACKOFF_US      10000
+
 #define ICE_AQ_FLAG_ERR                  (1 << 2)
 #define ICE_AQ_FLAG_BUF                  (1 << 12)  /* 0x1000 */
 #define ICE_AQ_FLAG_SI                   (1 << 13)  /* 0x2000 */
@@ -77,6 +87,23 @@
 
 extern driver_os_context_t Global_driver_os_ctx[family_last];
 
+/* CSR adminQ session - adminQ is acquired once for a batch of commands */
+typedef struct _ice_csr_session_t{
+    adapter_t* adapter;
+    bool       is_acquired;
+    uint32_t   number_of_commands;
+} ice_csr_session_t;
+
+/* Steps of the CSR discovery of a single adapter */
+typedef enum _ice_csr_state_t{
+    ice_csr_state_acquire,
+    ice_csr_state_send,
+    ice_csr_state_poll,
+    ice_csr_state_receive,
+    ice_csr_state_release,
+    ice_csr_state_done
+} ice_csr_state_t;
+
 typedef struct _ice_ddp_profile_t{
     ddp_profile_version_t version;
     char                  name[ICE_PROFILE_NAME_LENGTH];
@@ -105,6 +132,51 @@ typedef struct _ice_profiles_info_t{
     ice_ddp_profile_t     profile[ICE_PROFILES_NUMBER];
 } ice_profiles_info_t;
 
+/* Non-blocking CSR discovery of a single adapter driven by the event loop */
+typedef struct _ice_csr_machine_t{
+    discovery_job_t*    job;
+    adminq_desc_t*      descriptor;
+    ice_csr_session_t   session;
+    ice_csr_state_t     state;
+    ddp_status_t        status;
+    ice_profiles_info_t profiles_info;
+    uint64_t            poll_start;        /* in microseconds */
+    uint64_t            next_poll;         /* in microseconds */
+    uint32_t            backoff;           /* in microseconds */
+    uint32_t            polls;
+    uint32_t            number_of_ioctls;  /* ioctl counter at start of current command */
+    struct _ice_csr_machine_t* previous;   /* machine of the same device which has to finish first */
+} ice_csr_machine_t;
+
+/* Profile information of one PCI function reported by the DevLink INFO_GET dump */
+typedef struct _ice_devlink_info_t{
+    device_location_t location;
+    char              name[DDP_PROFILE_NAME_LENGTH];
+    char              version[DDP_VERSION_LENGTH];
+    char              track_id[DDP_TRACKID_LENGTH];
+} ice_devlink_info_t;
+
+/* Profile information of all DevLink devices, sorted by PCI location */
+#define ICE_DEVLINK_INFO_MAP_INITIAL_SIZE 16
+
+typedef struct _ice_devlink_info_map_t{
+    ice_devlink_info_t* entries;
+    uint32_t            number_of_entries;
+    uint32_t            capacity;
+} ice_devlink_info_map_t;
+
+/* DevLink region dump - region is read in windows, each window is one REGION_READ dump */
+#define ICE_REGION_DUMP_WINDOW_SIZE      (4 * 1024 * 1024)
+
+typedef struct _ice_region_dump_t{
+    FILE*    stream;
+    uint64_t region_size;      /* in bytes */
+    uint64_t bytes_written;
+    uint64_t elapsed_time;     /* in microseconds */
+    uint32_t number_of_windows;
+    bool     write_failed;
+} ice_region_dump_t;
+
 ddp_status_t
 ice_verify_driver(void);
 
@@ -117,4 +189,16 @@ ice_swx_verify_driver(void);
 void
 ice_initialize_device(adapter_t* adapter);
 
+uint32_t
+ice_prepare_discovery_batch(discovery_job_t* jobs, uint32_t number_of_jobs);
+
+void
+ice_run_discovery_batch(discovery_job_t* jobs, uint32_t number_of_jobs);
+
+ddp_status_t
+ice_dump_region(adapter_t* adapter, char* region, ice_region_dump_t* dump);
+
+void
+ice_release_devlink_info_map(void);
+
 #endif /* _DEF_ICE_H_ */
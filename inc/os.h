@@ -52,12 +52,18 @@ get_data_from_sysfs_files(adapter_t * adapter);
 ddp_status_t
 get_data_from_sysfs_config(adapter_t * adapter);
 
+bool
+is_intel_network_function(device_location_t* location);
+
 ddp_status_t
 get_driver_version_from_os(driver_os_version_t* driver_version, char* version_file_path);
 
 ddp_status_t
 get_branding_string_via_pci_ids(adapter_t* ddp_adapter, match_level* match_level);
 
+void
+release_pci_ids_index(void);
+
 char*
 replace_character(char* buffer, char find, char replace);
 
@@ -48,6 +48,9 @@ ddp_print(char* format, ...);
 
 /* Prototypes for ddp_func_print_adapter_list function pointer */
 
+ddp_status_t
+determine_output_stream(FILE** file, char* file_name);
+
 ddp_status_t
 generate_table_for_file(list_t* adapter_list, ddp_status_value_t tool_status, char* file_name);
 
@@ -26,12 +26,17 @@
 #include "cmdparams.h"
 
 static uint32_t static_command_line_parameters = 0;
-static char*           static_char_options = "f:s:ahlj::i:x::v?";
+static uint32_t static_discovery_thread_count  = DDP_DEFAULT_DISCOVERY_THREADS;
+static char*    static_dump_region             = NULL;
+static char*           static_char_options = "f:s:ahlj::i:x::t:v?";
 static struct option   static_string_options[] =
 {
-    {"help",  0, 0,    'h'},
-    {"help",  0, 0,    '?'},
-    {NULL,    0, NULL, 0}
+    {"help",           0, 0,    'h'},
+    {"help",           0, 0,    '?'},
+    {"selectors-file", 1, 0,    DDP_SELECTORS_FILE_COMMAND_PARAMETER},
+    {"dump-region",    1, 0,    DDP_DUMP_REGION_COMMAND_PARAMETER},
+    {"dump-file",      1, 0,    DDP_DUMP_FILE_COMMAND_PARAMETER},
+    {NULL,             0, NULL, 0}
 };
 
 bool
@@ -40,6 +45,18 @@ check_command_parameter(uint32_t param)
     return (static_command_line_parameters & param) ? TRUE : FALSE;
 }
 
+uint32_t
+get_discovery_thread_count(void)
+{
+    return static_discovery_thread_count;
+}
+
+char*
+get_dump_region(void)
+{
+    return static_dump_region;
+}
+
 bool
 is_character_printable(char character)
 {
@@ -112,6 +129,7 @@ validate_command_line_parameters(int argc, char** argv)
     uint32_t     option_index       = 0;
     uint32_t     parameter_index    = 0;
     uint32_t     parameter_length   = 0;
+    size_t       name_length        = 0;
     bool         is_parameter_found = FALSE;
 
     for(parameter_index = 1; (int)parameter_index < argc; parameter_index++)
@@ -132,13 +150,17 @@ validate_command_line_parameters(int argc, char** argv)
            current_parameter[0] == '-'                             &&
            current_parameter[1] == '-')
         {
+            /* Skip leading dashes, the value may be attached with '=' */
+            current_parameter += DDP_CMD_LINE_DOUBLE_DASH_PREFIX_SIZE;
+            name_length = strcspn(current_parameter, "=");
+
             /* Go through options structure to find long parameter typed by user */
+            option_index = 0;
             known_parameter = static_string_options[option_index].name;
             while(known_parameter != NULL && is_parameter_found != TRUE)
             {
-                /* Skip leading dashes */
-                current_parameter += DDP_CMD_LINE_DOUBLE_DASH_PREFIX_SIZE;
-                if(strcmp(current_parameter, known_parameter) == 0)
+                if(strlen(known_parameter) == name_length &&
+                   strncmp(current_parameter, known_parameter, name_length) == 0)
                 {
                     is_parameter_found = TRUE;
                     break;
@@ -201,8 +223,233 @@ validate_file_name(char* test_string)
     return status;
 }
 
+/* Function is_location_selector() checks if the selector is a PCI location
+ * in dddd:bb:ss.f format - otherwise it is treated as an interface name.
+ */
+bool
+is_location_selector(char* selector)
+{
+    device_location_t location;
+    char              separator_1 = '\0';
+    char              separator_2 = '\0';
+    char              separator_3 = '\0';
+
+    if(strlen(selector) != PCI_LOCATION_STRING_SIZE)
+    {
+        return FALSE;
+    }
+
+    if(sscanf(selector,
+              "%4hx%c%2hx%c%2hx%c%1hx",
+              &location.segment,
+              &separator_1,
+              &location.bus,
+              &separator_2,
+              &location.device,
+              &separator_3,
+              &location.function) != 7)
+    {
+        return FALSE;
+    }
+
+    return (separator_1 == ':' && separator_2 == ':' && separator_3 == '.') ? TRUE : FALSE;
+}
+
+ddp_status_t
+add_selector(list_t* selector_list, adapter_parameter_t type, char* key)
+{
+    selector_t*  selector   = NULL;
+    ddp_status_t status     = DDP_SUCCESS;
+    uint32_t     key_length = 0;
+
+    do
+    {
+        key_length = strlen(key);
+        if(key_length == 0 || key_length >= DDP_MAX_SELECTOR_LENGTH || is_string_printable(key) == FALSE)
+        {
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        selector = arena_malloc(sizeof(selector_t));
+        if(selector == NULL)
+        {
+            status = DDP_ALLOCATE_MEMORY_FAIL;
+            break;
+        }
+
+        selector->type = type;
+        strcpy_sec(selector->key, sizeof(selector->key), key, key_length);
+        if(type == adapter_location)
+        {
+            convert_to_lowercase(selector->key);
+        }
+
+        status = add_node_data(selector_list, (void*)selector, sizeof(selector_t));
+    } while(0);
+
+    return status;
+}
+
+/* Function parse_selectors() splits comma (or white space) separated list of selectors
+ * and adds each of them to the selector list. For adapter_none type the selector type
+ * is detected from its format.
+ *
+ * Parameters:
+ * [in,out] selector_list  Handle to selector list
+ * [in]     type           Type of selectors in the string
+ * [in]     selectors      String with selectors (modified by the function)
+ *
+ * Returns: DDP_SUCCESS or DDP_BAD_COMMAND_LINE_PARAMETER.
+ */
 ddp_status_t
-parse_command_line_parameters(int argc, char** argv, char** interface_key, char** file_name, char** input_file_name)
+parse_selectors(list_t* selector_list, adapter_parameter_t type, char* selectors)
+{
+    char*               key           = NULL;
+    char*               save_pointer  = NULL;
+    adapter_parameter_t selector_type = type;
+    ddp_status_t        status        = DDP_SUCCESS;
+    bool                is_found      = FALSE;
+
+    for(key = strtok_r(selectors, DDP_SELECTOR_SEPARATORS, &save_pointer);
+        key != NULL && status == DDP_SUCCESS;
+        key = strtok_r(NULL, DDP_SELECTOR_SEPARATORS, &save_pointer))
+    {
+        if(type == adapter_none)
+        {
+            selector_type = is_location_selector(key) == TRUE ? adapter_location : adapter_interface;
+        }
+        status = add_selector(selector_list, selector_type, key);
+        is_found = TRUE;
+    }
+
+    if(is_found == FALSE)
+    {
+        status = DDP_BAD_COMMAND_LINE_PARAMETER;
+    }
+
+    return status;
+}
+
+ddp_status_t
+parse_selectors_file(list_t* selector_list, char* file_name)
+{
+    char         line[DDP_MAX_BUFFER_SIZE];
+    FILE*        file      = NULL;
+    char*        comment   = NULL;
+    ddp_status_t status    = DDP_SUCCESS;
+    uint32_t     selectors = selector_list->number_of_nodes;
+
+    memset(line, '\0', sizeof(line));
+
+    do
+    {
+        if(validate_file_name(file_name) != DDP_SUCCESS)
+        {
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        file = fopen(file_name, "r");
+        if(file == NULL)
+        {
+            debug_ddp_print("Cannot open selectors file %s\n", file_name);
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        while(fgets(line, sizeof(line), file) != NULL)
+        {
+            comment = strchr(line, '#');
+            if(comment != NULL)
+            {
+                *comment = '\0';
+            }
+            if(strspn(line, DDP_SELECTOR_SEPARATORS) == strlen(line))
+            {
+                continue; /* empty line */
+            }
+
+            status = parse_selectors(selector_list, adapter_none, line);
+            if(status != DDP_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        if(status == DDP_SUCCESS && selector_list->number_of_nodes == selectors)
+        {
+            debug_ddp_print("No selectors in file %s\n", file_name);
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+        }
+    } while(0);
+
+    if(file != NULL)
+    {
+        fclose(file);
+    }
+
+    return status;
+}
+
+ddp_status_t
+parse_thread_count(char* thread_count_string, uint32_t* thread_count)
+{
+    char*         end_pointer        = NULL;
+    unsigned long thread_count_value = 0;
+    ddp_status_t  status             = DDP_SUCCESS;
+
+    do
+    {
+        if(thread_count_string == NULL || thread_count == NULL)
+        {
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        errno = 0;
+        thread_count_value = strtoul(thread_count_string, &end_pointer, DDP_DECIMAL_SYSTEM);
+        if(errno != 0 || end_pointer == thread_count_string || *end_pointer != '\0' ||
+           thread_count_value == 0 || thread_count_value > DDP_MAX_DISCOVERY_THREADS)
+        {
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        *thread_count = (uint32_t)thread_count_value;
+    } while(0);
+
+    return status;
+}
+
+ddp_status_t
+parse_dump_region(char* region)
+{
+    ddp_status_t status = DDP_SUCCESS;
+
+    do
+    {
+        if(region == NULL)
+        {
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        if(strcmp(region, DDP_DUMP_REGION_FLASH) != 0 && strcmp(region, DDP_DUMP_REGION_CAPS) != 0)
+        {
+            debug_ddp_print("Unknown region %s\n", region);
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        static_dump_region = region;
+    } while(0);
+
+    return status;
+}
+
+ddp_status_t
+parse_command_line_parameters(int argc, char** argv, list_t* selector_list, char** file_name, char** input_file_name)
 {
     ddp_status_t status       = DDP_SUCCESS;
     int          parameter    = 0;
@@ -245,26 +492,34 @@ parse_command_line_parameters(int argc, char** argv, char** interface_key, char*
                 static_command_line_parameters |= DDP_ALL_ADAPTERS_PARAMETER_BIT;
                 break;
             case DDP_LOCATION_COMMAND_PARAMETER:
-                status = CHECK_DUPLICATE(DDP_LOCATION_COMMAND_PARAMETER_BIT);
+                /* '-s' may be repeated and may contain comma separated list */
                 if(optarg == NULL)
                 {
                     status = DDP_BAD_COMMAND_LINE_PARAMETER;
                     break;
                 }
-                *interface_key = optarg;
-                convert_to_lowercase(*interface_key);
+                status = parse_selectors(selector_list, adapter_location, optarg);
                 static_command_line_parameters |= DDP_LOCATION_COMMAND_PARAMETER_BIT;
                 break;
             case DDP_INTERFACE_COMMAND_PARAMETER:
-                status = CHECK_DUPLICATE(DDP_INTERFACE_COMMAND_PARAMETER_BIT);
+                /* '-i' may be repeated and may contain comma separated list */
                 if(optarg == NULL)
                 {
                     status = DDP_BAD_COMMAND_LINE_PARAMETER;
                     break;
                 }
-                *interface_key = optarg;
+                status = parse_selectors(selector_list, adapter_interface, optarg);
                 static_command_line_parameters |= DDP_INTERFACE_COMMAND_PARAMETER_BIT;
                 break;
+            case DDP_SELECTORS_FILE_COMMAND_PARAMETER:
+                status = CHECK_DUPLICATE(DDP_SELECTORS_FILE_COMMAND_PARAMETER_BIT);
+                if(status != DDP_SUCCESS)
+                {
+                    break;
+                }
+                status = parse_selectors_file(selector_list, optarg);
+                static_command_line_parameters |= DDP_SELECTORS_FILE_COMMAND_PARAMETER_BIT;
+                break;
             case DDP_HELP1_COMMAND_PARAMETER:
             case DDP_HELP2_COMMAND_PARAMETER:
                 status = CHECK_DUPLICATE(DDP_HELP_COMMAND_PARAMETER_BIT);
@@ -314,16 +569,49 @@ parse_command_line_parameters(int argc, char** argv, char** interface_key, char*
                 *input_file_name = optarg;
                 static_command_line_parameters |= DDP_PARSE_FILE_COMMAND_PARAMETER_BIT;
                 break;
+            case DDP_THREADS_COMMAND_PARAMETER:
+                status = CHECK_DUPLICATE(DDP_THREADS_COMMAND_PARAMETER_BIT);
+                if(status != DDP_SUCCESS)
+                {
+                    break;
+                }
+                status = parse_thread_count(optarg, &static_discovery_thread_count);
+                static_command_line_parameters |= DDP_THREADS_COMMAND_PARAMETER_BIT;
+                break;
+            case DDP_DUMP_REGION_COMMAND_PARAMETER:
+                status = CHECK_DUPLICATE(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT);
+                if(status != DDP_SUCCESS)
+                {
+                    break;
+                }
+                status = parse_dump_region(optarg);
+                static_command_line_parameters |= DDP_DUMP_REGION_COMMAND_PARAMETER_BIT;
+                break;
+            case DDP_DUMP_FILE_COMMAND_PARAMETER:
+                status = CHECK_DUPLICATE(DDP_DUMP_FILE_COMMAND_PARAMETER_BIT);
+                if(validate_file_name(optarg) != DDP_SUCCESS)
+                {
+                    status = DDP_BAD_COMMAND_LINE_PARAMETER;
+                    break;
+                }
+                *file_name = optarg;
+                static_command_line_parameters |= DDP_DUMP_FILE_COMMAND_PARAMETER_BIT;
+                break;
             default:
                 status = DDP_BAD_COMMAND_LINE_PARAMETER;
                 break;
             }
 
-            if(CONFLICT_PARAMETERS(DDP_LOCATION_COMMAND_PARAMETER_BIT, DDP_INTERFACE_COMMAND_PARAMETER_BIT) ||  /* cannot use '-s' and '-i' at the same execution */
-               CONFLICT_PARAMETERS(DDP_XML_COMMAND_PARAMETER_BIT, DDP_JSON_COMMAND_PARAMETER_BIT)           ||  /* cannot use xml and json at the same execution */
+            if(CONFLICT_PARAMETERS(DDP_XML_COMMAND_PARAMETER_BIT, DDP_JSON_COMMAND_PARAMETER_BIT)           ||  /* cannot use xml and json at the same execution */
                CONFLICT_PARAMETERS(DDP_PARSE_FILE_COMMAND_PARAMETER_BIT, DDP_INTERFACE_COMMAND_PARAMETER_BIT)   ||  /* cannot use '-f' with adapter specific parameter ('-i') */
                CONFLICT_PARAMETERS(DDP_PARSE_FILE_COMMAND_PARAMETER_BIT, DDP_LOCATION_COMMAND_PARAMETER_BIT)    ||  /* cannot use '-f' with adapter specific parameter ('-s') */
-               CONFLICT_PARAMETERS(DDP_PARSE_FILE_COMMAND_PARAMETER_BIT, DDP_ALL_ADAPTERS_PARAMETER_BIT)            /* cannot use '-f' with adapter specific parameter ('-a') */
+               CONFLICT_PARAMETERS(DDP_PARSE_FILE_COMMAND_PARAMETER_BIT, DDP_ALL_ADAPTERS_PARAMETER_BIT)        ||  /* cannot use '-f' with adapter specific parameter ('-a') */
+               CONFLICT_PARAMETERS(DDP_PARSE_FILE_COMMAND_PARAMETER_BIT, DDP_SELECTORS_FILE_COMMAND_PARAMETER_BIT) ||  /* cannot use '-f' with adapter specific parameter ('--selectors-file') */
+               CONFLICT_PARAMETERS(DDP_PARSE_FILE_COMMAND_PARAMETER_BIT, DDP_THREADS_COMMAND_PARAMETER_BIT)         ||  /* cannot use '-f' with discovery parameter ('-t') */
+               CONFLICT_PARAMETERS(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT, DDP_PARSE_FILE_COMMAND_PARAMETER_BIT)     ||  /* cannot dump region in binary file analyzing mode */
+               CONFLICT_PARAMETERS(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT, DDP_ALL_ADAPTERS_PARAMETER_BIT)           ||  /* region is dumped for one device only */
+               CONFLICT_PARAMETERS(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT, DDP_XML_COMMAND_PARAMETER_BIT)            ||  /* dump has its own output ('--dump-file') */
+               CONFLICT_PARAMETERS(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT, DDP_JSON_COMMAND_PARAMETER_BIT)               /* dump has its own output ('--dump-file') */
               )
             {
                 status = DDP_BAD_COMMAND_LINE_PARAMETER;
@@ -334,6 +622,28 @@ parse_command_line_parameters(int argc, char** argv, char** interface_key, char*
                 break;
             }
         }
+        if(status != DDP_SUCCESS)
+        {
+            break;
+        }
+
+        /* '--dump-file' is valid only with '--dump-region' */
+        if(check_command_parameter(DDP_DUMP_FILE_COMMAND_PARAMETER_BIT) == TRUE &&
+           check_command_parameter(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT) == FALSE)
+        {
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
+
+        /* '--dump-region' requires exactly one device selected by '-s', '-i' or '--selectors-file' */
+        if(check_command_parameter(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT) == TRUE &&
+           check_command_parameter(DDP_HELP_COMMAND_PARAMETER_BIT) == FALSE   &&
+           selector_list->number_of_nodes != 1)
+        {
+            debug_ddp_print("Region dump requires exactly one device\n");
+            status = DDP_BAD_COMMAND_LINE_PARAMETER;
+            break;
+        }
     } while(0);
 
     return status;
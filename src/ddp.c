@@ -25,6 +25,8 @@
 
 #include "ddp.h"
 #include "cmdparams.h"
+#include "qdl_i.h"
+#include "qdl_codes.h"
 
 driver_os_context_t Global_driver_os_ctx[family_last];
 
@@ -125,227 +127,336 @@ is_virtual_function(adapter_t* adapter)
     return is_virtual;
 }
 
-/* Function get_brading_string_from_table() find the branding string for a
- * given device in internal table.
- *
- * The recognize is done by matching device's 4-partID (VendorID, DeviceID,
- * SubvendorID and SubdeviceID) and if that fails - 2-partID (VendorID and
- * DeviceID). If a match is found this function sets adapter->branding_string
- * value for the current adapter. The list of legal devices is stored in
- * supported devices lists specific for each family. This matching assumes that
- * supported devices lists use 0xFFFF values in 4-partID entries as generic values.
- *
- * Parameters:
- * [in,out] adapter      Handle to current adapter
- * [out]    match_level  4 if 4-PartId match, 2 if 2-PartId match, 0 if no match
+/* Sorted index over supported devices tables of all families */
+static supported_device_index_t* supported_devices_index      = NULL;
+static uint32_t                  supported_devices_index_size = 0;
+
+int
+compare_supported_device_index(const void* first, const void* second)
+{
+    const supported_device_index_t* a = (const supported_device_index_t*)first;
+    const supported_device_index_t* b = (const supported_device_index_t*)second;
+
+    if(a->key != b->key)
+    {
+        return (a->key < b->key) ? -1 : 1;
+    }
+
+    /* keep table order for duplicated entries - the first one wins as in linear search */
+    return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+
+/* Function build_supported_devices_index() builds once per run a sorted index over
+ * supported devices tables of all families, keyed on the 4-part ID.
  *
- * Returns: None
+ * Returns: DDP_SUCCESS or DDP_ALLOCATE_MEMORY_FAIL.
  */
-void
-get_brading_string_from_table(adapter_t* adapter, match_level* match_level)
+ddp_status_t
+build_supported_devices_index(void)
 {
     supported_devices_t* supported_devices      = NULL;
     adapter_family_t     adapter_family         = family_none;
+    ddp_status_t         status                 = DDP_SUCCESS;
     uint16_t             supported_devices_size = 0;
     uint16_t             i                      = 0;
-    uint16_t             a_ven_id               = adapter->vendor_id;
-    uint16_t             a_dev_id               = adapter->device_id;
-    uint16_t             a_sub_ven_id           = adapter->subvendor_id;
-    uint16_t             a_sub_dev_id           = adapter->subdevice_id;
-    uint16_t             generic_id             = 0xFFFF;
-    bool                 is_supported           = FALSE;
-
-    for(adapter_family = family_40G; adapter_family < family_last; adapter_family++)
+    uint32_t             index_size             = 0;
+
+    do
     {
-        switch(adapter_family)
+        if(supported_devices_index != NULL)
         {
-        case family_40G:
-            supported_devices = i40e_supported_devices;
-            supported_devices_size = i40e_supported_devices_size;
             break;
-        case family_100G:
-            supported_devices = ice_supported_devices;
-            supported_devices_size = ice_supported_devices_size;
-            break;
-        default:
-            supported_devices = NULL;
-            supported_devices_size = 0;
+        }
+
+        supported_devices_index = malloc_sec(sizeof(supported_device_index_t) *
+                                             (i40e_supported_devices_size + ice_supported_devices_size));
+        if(supported_devices_index == NULL)
+        {
+            status = DDP_ALLOCATE_MEMORY_FAIL;
             break;
         }
 
-        do
+        for(adapter_family = family_40G; adapter_family < family_last; adapter_family++)
         {
-            for(i = 0; i < supported_devices_size; i++)
-            {
-                if(a_ven_id     == supported_devices[i].vendorid    &&
-                   a_dev_id     == supported_devices[i].deviceid    &&
-                   a_sub_ven_id == supported_devices[i].subvendorid &&
-                   a_sub_dev_id == supported_devices[i].subdeviceid
-                  )
-                {
-                    if(adapter->branding_string_allocated == TRUE)
-                    {
-                        free_memory(adapter->branding_string);
-                        adapter->branding_string_allocated = FALSE;
-                    }
-                    adapter->branding_string = supported_devices[i].branding_string;
-                    is_supported = TRUE;
-                    adapter->adapter_family = adapter_family;
-                    *match_level = four_part_id_match;
-                    break;
-                }
-            }
-            /* if tool doesn't find match for generic sub_ven & sub_dev the loop shall be broken */
-            if(((a_sub_ven_id & a_sub_dev_id) == generic_id) && (is_supported == FALSE))
+            switch(adapter_family)
             {
+            case family_40G:
+                supported_devices = i40e_supported_devices;
+                supported_devices_size = i40e_supported_devices_size;
                 break;
-            }
-            if(is_supported == TRUE)
-            {
-                if((a_sub_dev_id & a_sub_ven_id) == generic_id) /* 2-partID match */
-                {
-                    *match_level = device_id_match;
-                }
-                else /* 4-partID match */
-                {
-                    *match_level = four_part_id_match;
-                }
-
+            case family_100G:
+                supported_devices = ice_supported_devices;
+                supported_devices_size = ice_supported_devices_size;
+                break;
+            default:
+                supported_devices = NULL;
+                supported_devices_size = 0;
                 break;
             }
-            else
+
+            for(i = 0; i < supported_devices_size; i++)
             {
-                /* 4-partID matching failed - try 2-partID */
-                a_sub_ven_id = generic_id;
-                a_sub_dev_id = generic_id;
+                supported_devices_index[index_size].key = DDP_4_PART_ID_KEY(supported_devices[i].vendorid,
+                                                                             supported_devices[i].deviceid,
+                                                                             supported_devices[i].subvendorid,
+                                                                             supported_devices[i].subdeviceid);
+                supported_devices_index[index_size].device         = &supported_devices[i];
+                supported_devices_index[index_size].adapter_family = adapter_family;
+                supported_devices_index[index_size].order          = index_size;
+                index_size++;
             }
-        } while(TRUE);
+        }
 
-        if(is_supported == TRUE)
+        qsort(supported_devices_index,
+              index_size,
+              sizeof(supported_device_index_t),
+              compare_supported_device_index);
+        supported_devices_index_size = index_size;
+    } while(0);
+
+    return status;
+}
+
+void
+free_supported_devices_index(void)
+{
+    free_memory(supported_devices_index);
+    supported_devices_index      = NULL;
+    supported_devices_index_size = 0;
+}
+
+/* Function find_supported_device() returns the first index entry with the given key.
+ *
+ * Returns: Handle to index entry or NULL if there is no such entry.
+ */
+supported_device_index_t*
+find_supported_device(uint64_t key)
+{
+    uint32_t low    = 0;
+    uint32_t high   = supported_devices_index_size;
+    uint32_t middle = 0;
+
+    /* lower bound - the first entry with key not less than searched one */
+    while(low < high)
+    {
+        middle = low + (high - low) / 2;
+        if(supported_devices_index[middle].key < key)
         {
-            /* match found, exit search */
-            break;
+            low = middle + 1;
         }
-        /* reset sub fields for the next family */
-        a_sub_ven_id = adapter->subvendor_id;
-        a_sub_dev_id = adapter->subdevice_id;
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if(low < supported_devices_index_size && supported_devices_index[low].key == key)
+    {
+        return &supported_devices_index[low];
     }
+
+    return NULL;
 }
 
-/* Function verifies if there is a supported virtual functions driver attached
- * to that specific device.
+/* Function get_brading_string_from_table() find the branding string for a
+ * given device in internal table.
+ *
+ * The recognize is done by matching device's 4-partID (VendorID, DeviceID,
+ * SubvendorID and SubdeviceID) and if that fails - 2-partID (VendorID and
+ * DeviceID). Both searches are binary searches in the sorted index built over
+ * the supported devices lists of all families. If a match is found this function
+ * sets adapter->branding_string and adapter->adapter_family for the current adapter.
+ * This matching assumes that supported devices lists use 0xFFFF values in 4-partID
+ * entries as generic values.
  *
  * Parameters:
  * [in,out] adapter      Handle to current adapter
+ * [out]    match_level  4 if 4-PartId match, 2 if 2-PartId match, 0 if no match
  *
- * Returns: TRUE if virtual functions driver is supported and FALSE if it is not.
+ * Returns: None
  */
-bool
-is_supported_vf_driver(adapter_t* adapter)
+void
+get_brading_string_from_table(adapter_t* adapter, match_level* match_level)
 {
-    char             path_to_vf_pci_device[DDP_MAX_BUFFER_SIZE];
-    char             path_to_pf_driver[DDP_MAX_BUFFER_SIZE];
-    char             link_to_pf_driver[DDP_MAX_BUFFER_SIZE];
-    struct stat      node_attributes                             = {0};
-    ssize_t          readlink_result                             = 0;
-    char*            pf_driver_name                              = NULL;
-    int              stat_result                                 = 0;
-    bool             is_supported                                = FALSE;
-
-    memset(path_to_vf_pci_device, '\0', sizeof(path_to_vf_pci_device));
-    memset(path_to_pf_driver,     '\0', sizeof(path_to_pf_driver));
-    memset(link_to_pf_driver,     '\0', sizeof(link_to_pf_driver));
+    supported_device_index_t* entry      = NULL;
+    uint16_t                  generic_id = 0xFFFF;
 
     do
     {
-        /* check for symlink to the device file */
-        snprintf(path_to_vf_pci_device,
-                 sizeof(path_to_vf_pci_device),
-                 "%s%s/%04x:%02x:%02x.%d/",
-                 PATH_TO_PCI_DRIVERS,
-                 DDP_DRIVER_NAME_AVF,
-                 adapter->location.segment,
-                 adapter->location.bus,
-                 adapter->location.device,
-                 adapter->location.function);
-
-        /* use stat() to follow the symlink from ../drivers into ../devices */
-        stat_result = stat(path_to_vf_pci_device, &node_attributes);
-        if(stat_result != 0 || S_ISDIR(node_attributes.st_mode) == FALSE)
+        if(build_supported_devices_index() != DDP_SUCCESS)
         {
+            debug_ddp_print("Cannot build supported devices index\n");
             break;
         }
 
-        strcpy_sec(path_to_pf_driver,
-                   sizeof(path_to_pf_driver),
-                   path_to_vf_pci_device,
-                   strlen(path_to_vf_pci_device));
-        strcat_sec(path_to_pf_driver,
-                   sizeof(path_to_pf_driver),
-                   DDP_PF_DRIVER_LINK_IN_VF_DEVICE,
-                   strlen(DDP_PF_DRIVER_LINK_IN_VF_DEVICE));
-        /* use stat() to follow the symlink in physical function */
-        stat_result = stat(path_to_pf_driver, &node_attributes);
-        if(stat_result != 0 || S_ISDIR(node_attributes.st_mode) == FALSE)
+        entry = find_supported_device(DDP_4_PART_ID_KEY(adapter->vendor_id,
+                                                        adapter->device_id,
+                                                        adapter->subvendor_id,
+                                                        adapter->subdevice_id));
+        if(entry == NULL)
         {
-            debug_ddp_print("Invalid directory: %s.\n", path_to_pf_driver);
-            break;
+            /* 4-partID matching failed - try 2-partID */
+            entry = find_supported_device(DDP_4_PART_ID_KEY(adapter->vendor_id,
+                                                            adapter->device_id,
+                                                            generic_id,
+                                                            generic_id));
         }
-
-        /* read physical function driver link */
-        readlink_result = readlink(path_to_pf_driver,
-                                   link_to_pf_driver,
-                                   sizeof(link_to_pf_driver) - 1);
-        if(readlink_result <= 0)
+        if(entry == NULL)
         {
-            debug_ddp_print("readlink error (%ld) on path: %s.\n",
-                            readlink_result,
-                            path_to_pf_driver);
             break;
         }
-        if(readlink_result == sizeof(link_to_pf_driver) - 1)
+
+        if(adapter->branding_string_allocated == TRUE)
         {
-            /* link could be trunkated so check if directory exists */
-            stat_result = stat(link_to_pf_driver, &node_attributes);
-            if(stat_result != 0 || S_ISDIR(node_attributes.st_mode) == FALSE)
-            {
-                debug_ddp_print("Couldn't find directory. \
-                                 Link could be truncated: %s.\n", link_to_pf_driver);
-                break;
-            }
+            free_memory(adapter->branding_string);
+            adapter->branding_string_allocated = FALSE;
         }
+        adapter->branding_string = entry->device->branding_string;
+        adapter->adapter_family  = entry->adapter_family;
 
-        /* get driver name */
-        pf_driver_name = strrchr(link_to_pf_driver, '/');
-        if(pf_driver_name == NULL)
+        if((entry->device->subvendorid & entry->device->subdeviceid) == generic_id) /* 2-partID match */
         {
-            debug_ddp_print("strrchr error.\n");
-            break;
+            *match_level = device_id_match;
         }
-        pf_driver_name++;
-
-        /* assign adapter family based on driver name */
-        if(strcmp(DDP_DRIVER_NAME_40G, pf_driver_name) == 0)
+        else /* 4-partID match */
         {
-            adapter->adapter_family = family_40G;
+            *match_level = four_part_id_match;
         }
-        else if(strcmp(DDP_DRIVER_NAME_100G, pf_driver_name) == 0)
+    } while(0);
+}
+
+/* Table used to resolve adapter family from the name of the driver bound to the device */
+driver_family_t Global_driver_family_table[] =
+{
+    {DDP_DRIVER_NAME_40G,       family_40G},
+    {DDP_DRIVER_NAME_100G,      family_100G},
+    {DDP_DRIVER_NAME_100G_SW,   family_100G_SW},
+    {DDP_DRIVER_NAME_100G_SWX,  family_100G_SWX}
+};
+uint16_t Global_driver_family_table_size = sizeof(Global_driver_family_table)/sizeof(Global_driver_family_table[0]);
+
+/* Function get_family_by_driver_name() looks up the adapter family for the given driver name.
+ *
+ * Parameters:
+ * [in] driver_name  Name of the driver bound to the device
+ *
+ * Returns: Adapter family or family_none if driver is not supported.
+ */
+adapter_family_t
+get_family_by_driver_name(char* driver_name)
+{
+    adapter_family_t adapter_family = family_none;
+    uint16_t         i              = 0;
+
+    for(i = 0; i < Global_driver_family_table_size; i++)
+    {
+        if(strcmp(Global_driver_family_table[i].driver_name, driver_name) == 0)
         {
-            adapter->adapter_family = family_100G;
+            adapter_family = Global_driver_family_table[i].adapter_family;
+            break;
+        }
+    }
+
+    return adapter_family;
+}
+
+/* Function get_device_driver_name() reads the name of the driver bound to the device
+ * with a single readlink() of /sys/bus/pci/devices/<bdf>/<driver_link>.
+ *
+ * Parameters:
+ * [in]  location          PCI location of the device
+ * [in]  driver_link       Path of the driver link relative to the device directory
+ * [out] driver_name       Buffer for driver name
+ * [in]  driver_name_size  Size of driver_name buffer
+ *
+ * Returns: DDP_SUCCESS if driver is bound to the device, error code otherwise.
+ */
+ddp_status_t
+get_device_driver_name(device_location_t* location, char* driver_link, char* driver_name, uint32_t driver_name_size)
+{
+    char         path_to_driver_link[DDP_MAX_BUFFER_SIZE];
+    char         link_to_driver[DDP_MAX_BUFFER_SIZE];
+    char*        name            = NULL;
+    ssize_t      readlink_result = 0;
+    ddp_status_t status          = DDP_SUCCESS;
+
+    memset(path_to_driver_link, '\0', sizeof(path_to_driver_link));
+    memset(link_to_driver,      '\0', sizeof(link_to_driver));
+
+    do
+    {
+        snprintf(path_to_driver_link,
+                 sizeof(path_to_driver_link),
+                 "%s%04x:%02x:%02x.%d/%s",
+                 PATH_TO_SYSFS_PCI,
+                 location->segment,
+                 location->bus,
+                 location->device,
+                 location->function,
+                 driver_link);
+
+        readlink_result = readlink(path_to_driver_link, link_to_driver, sizeof(link_to_driver) - 1);
+        if(readlink_result <= 0 || readlink_result == sizeof(link_to_driver) - 1)
+        {
+            /* no driver bound to the device or link truncated */
+            status = DDP_FILE_ACCESS_ERROR;
+            break;
         }
-        else if(strcmp(DDP_DRIVER_NAME_100G_SW, pf_driver_name) == 0)
+
+        name = strrchr(link_to_driver, '/');
+        name = (name == NULL) ? link_to_driver : name + 1;
+
+        status = strcpy_sec(driver_name, driver_name_size, name, strlen(name));
+    } while(0);
+
+    return status;
+}
+
+/* Function verifies if there is a supported virtual functions driver attached
+ * to that specific device.
+ *
+ * Parameters:
+ * [in,out] adapter      Handle to current adapter
+ * [in]     driver_name  Name of the driver bound to the device
+ *
+ * Returns: TRUE if virtual functions driver is supported and FALSE if it is not.
+ */
+bool
+is_supported_vf_driver(adapter_t* adapter, char* driver_name)
+{
+    char             pf_driver_name[DDP_MAX_NAME_LENGTH];
+    ddp_status_t     status                              = DDP_SUCCESS;
+    adapter_family_t adapter_family                      = family_none;
+    bool             is_supported                        = FALSE;
+
+    memset(pf_driver_name, '\0', sizeof(pf_driver_name));
+
+    do
+    {
+        if(strcmp(DDP_DRIVER_NAME_AVF, driver_name) != 0)
         {
-            adapter->adapter_family = family_100G_SW;
+            break;
         }
-        else if(strcmp(DDP_DRIVER_NAME_100G_SWX, pf_driver_name) == 0)
+
+        /* read physical function driver link */
+        status = get_device_driver_name(&adapter->location,
+                                        DDP_PF_DRIVER_LINK_IN_VF_DEVICE,
+                                        pf_driver_name,
+                                        sizeof(pf_driver_name));
+        if(status != DDP_SUCCESS)
         {
-            adapter->adapter_family = family_100G_SWX;
+            debug_ddp_print("Cannot read pf driver link: 0x%X.\n", status);
+            break;
         }
-        else
+
+        /* assign adapter family based on driver name */
+        adapter_family = get_family_by_driver_name(pf_driver_name);
+        if(adapter_family == family_none)
         {
             debug_ddp_print("Unknown pf driver name: %s.\n", pf_driver_name);
             break;
         }
+        adapter->adapter_family = adapter_family;
         is_supported = TRUE;
         debug_ddp_print("iavf driver support for: %s found.\n", pf_driver_name);
     } while(0);
@@ -360,23 +471,17 @@ is_supported_vf_driver(adapter_t* adapter)
  *
  * Parameters:
  * [in,out] adapter      Handle to current adapter
+ * [in]     driver_name  Name of the driver bound to the device
  *
  * Returns: TRUE if driver is supported and FALSE if it is not.
  */
 bool
-is_supported_driver(adapter_t* adapter)
+is_supported_driver(adapter_t* adapter, char* driver_name)
 {
-    char             path_to_pci_device[DDP_MAX_BUFFER_SIZE];
-    char             driver_name[DDP_MAX_NAME_LENGTH];
-    struct stat      node_attributes                         = {0};
-    adapter_family_t adapter_family                          = family_none;
-    uint32_t         i                                       = 0;
-    int              stat_result                             = 0;
-    bool             unsupported_device                      = FALSE;
-    bool             is_supported                            = FALSE;
-
-    memset(path_to_pci_device, '\0',DDP_MAX_BUFFER_SIZE);
-    memset(driver_name, '\0',DDP_MAX_NAME_LENGTH);
+    adapter_family_t adapter_family     = family_none;
+    uint32_t         i                  = 0;
+    bool             unsupported_device = FALSE;
+    bool             is_supported       = FALSE;
 
     do
     {
@@ -394,49 +499,11 @@ is_supported_driver(adapter_t* adapter)
             break;
         }
 
-        for(adapter_family = family_40G; adapter_family < family_last; adapter_family++)
+        adapter_family = get_family_by_driver_name(driver_name);
+        if(adapter_family != family_none)
         {
-            switch(adapter_family)
-            {
-            case family_40G:
-                strcpy_sec(driver_name, DDP_MAX_NAME_LENGTH, DDP_DRIVER_NAME_40G, strlen(DDP_DRIVER_NAME_40G));
-                break;
-            case family_100G:
-                strcpy_sec(driver_name, DDP_MAX_NAME_LENGTH, DDP_DRIVER_NAME_100G, strlen(DDP_DRIVER_NAME_100G));
-                break;
-            case family_100G_SW:
-                strcpy_sec(driver_name, DDP_MAX_NAME_LENGTH, DDP_DRIVER_NAME_100G_SW, strlen(DDP_DRIVER_NAME_100G_SW));
-                break;
-            case family_100G_SWX:
-                strcpy_sec(driver_name, DDP_MAX_NAME_LENGTH, DDP_DRIVER_NAME_100G_SWX, strlen(DDP_DRIVER_NAME_100G_SWX));
-                break;
-            default:
-                memset(driver_name, '\0', sizeof(char)*DDP_MAX_NAME_LENGTH);
-                break;
-            }
-
-            /* check for symlink to the device file */
-            snprintf(path_to_pci_device,
-                     DDP_MAX_BUFFER_SIZE,
-                     "%s%s/%04x:%02x:%02x.%d/",
-                     PATH_TO_PCI_DRIVERS,
-                     driver_name,
-                     adapter->location.segment,
-                     adapter->location.bus,
-                     adapter->location.device,
-                     adapter->location.function);
-
-            /* use stat() instead of lstat() to follow the symlink from ../drivers into ../devices */
-            stat_result = stat(path_to_pci_device, &node_attributes);
-            if(stat_result == 0)
-            {
-                if (S_ISDIR(node_attributes.st_mode) == TRUE)
-                {
-                    adapter->adapter_family = adapter_family;
-                    is_supported = TRUE;
-                    break;
-                }
-            }
+            adapter->adapter_family = adapter_family;
+            is_supported = TRUE;
         }
     } while(0);
 
@@ -455,17 +522,27 @@ is_supported_driver(adapter_t* adapter)
 bool
 is_device_supported(adapter_t* adapter)
 {
+    char         driver_name[DDP_MAX_NAME_LENGTH];
     ddp_status_t func_status  = DDP_SUCCESS;
     match_level  match_level  = no_match;
     bool         is_supported = FALSE;
 
+    memset(driver_name, '\0', sizeof(driver_name));
+
     do
     {
-        is_supported = is_supported_driver(adapter);
+        func_status = get_device_driver_name(&adapter->location, DDP_DRIVER_LINK_IN_DEVICE, driver_name, sizeof(driver_name));
+        if(func_status != DDP_SUCCESS)
+        {
+            debug_ddp_print("No driver bound to the device.\n");
+            break;
+        }
+
+        is_supported = is_supported_driver(adapter, driver_name);
         if(is_supported == FALSE)
         {
             /* if device wasn't found under base driver, it may be supported by adaptive vf driver */
-            is_supported = is_supported_vf_driver(adapter);
+            is_supported = is_supported_vf_driver(adapter, driver_name);
         }
         if(is_supported == TRUE)
         {
@@ -497,10 +574,11 @@ is_device_supported(adapter_t* adapter)
 ddp_status_t
 get_connection_name(adapter_t* adapter)
 {
-    char           path_to_net_names[300] = {'\0'};
-    struct dirent* entry                  = NULL;
-    DIR*           dir                    = NULL;
-    ddp_status_t   status                 = DDP_UNKNOWN_ETH_NAME;
+    char         connection_name[IFNAMSIZ];
+    ddp_status_t status                    = DDP_UNKNOWN_ETH_NAME;
+    qdl_status_t qdl_status                = QDL_SUCCESS;
+
+    memset(connection_name, '\0', sizeof(connection_name));
 
     /* Set default value */
     strcpy_sec(adapter->connection_name,
@@ -508,57 +586,51 @@ get_connection_name(adapter_t* adapter)
                DDP_CONNECTION_NAME_NOT_AVAILABLE,
                strlen(DDP_CONNECTION_NAME_NOT_AVAILABLE));
 
-    snprintf(path_to_net_names,
-             sizeof(path_to_net_names),
-             "%s/%04x:%02x:%02x.%x/net",
-             PATH_TO_SYSFS_PCI,
-             adapter->location.segment,
-             adapter->location.bus,
-             adapter->location.device,
-             adapter->location.function);
-
-    dir = opendir(path_to_net_names);
-    if(dir == NULL)
-        return status;
-
-    while((entry = readdir(dir)) != NULL)
+    /* BDF->ifname map is built once per run from a single link dump */
+    qdl_status = qdl_get_pci_net_interface(adapter->location.segment,
+                                           adapter->location.bus,
+                                           adapter->location.device,
+                                           adapter->location.function,
+                                           connection_name,
+                                           sizeof(connection_name));
+    if(qdl_status == QDL_SUCCESS)
     {
-        if(entry->d_name[0] == '.')
-            continue;
-
         strcpy_sec(adapter->connection_name,
                    sizeof adapter->connection_name,
-                   entry->d_name,
-                   strlen(entry->d_name));
+                   connection_name,
+                   strlen(connection_name));
         status = DDP_SUCCESS;
-        break;
     }
 
-    closedir(dir);
-
     return status;
 }
 
+/* Function open_ioctl_transport() opens the socket and prepares the interface request used
+ * for all base driver ioctl calls of the adapter. For usable virtual functions requests are
+ * sent through the PF interface. Transport which is already open is reused.
+ *
+ * Parameters:
+ * [in,out] adapter      Handle to current adapter
+ *
+ * Returns: DDP_SUCCESS or DDP_CANNOT_COMMUNICATE_ADAPTER.
+ */
 ddp_status_t
-get_data_by_basedriver(adapter_t* adapter, ioctl_structure_t* ioctl_structure)
+open_ioctl_transport(adapter_t* adapter)
 {
-    ifreq_t      ifreq;
-    ddp_status_t status            = DDP_SUCCESS;
-    int          result            = 0;
-    int          socket_descriptor = 0;
-
-    memset(&ifreq, 0, sizeof ifreq);
+    ioctl_transport_t* transport = &adapter->transport;
+    ddp_status_t       status    = DDP_SUCCESS;
 
     do
     {
-        if(adapter == NULL || ioctl_structure == NULL)
+        if(transport->is_open == TRUE)
         {
-            status = DDP_INCORRECT_FUNCTION_PARAMETERS;
             break;
         }
 
-        socket_descriptor = socket(AF_INET, SOCK_DGRAM, 0);
-        if(socket_descriptor < 0)
+        memset(&transport->ifreq, 0, sizeof transport->ifreq);
+
+        transport->socket_descriptor = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if(transport->socket_descriptor < 0)
         {
             status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             break;
@@ -568,75 +640,176 @@ get_data_by_basedriver(adapter_t* adapter, ioctl_structure_t* ioctl_structure)
            adapter->is_usable == TRUE)
         {
             /* for virtual functions we need a connection name from PF */
-            strcpy_sec(ifreq.ifr_name,
-                       sizeof ifreq.ifr_name,
+            strcpy_sec(transport->ifreq.ifr_name,
+                       sizeof transport->ifreq.ifr_name,
                        adapter->pf_connection_name,
                        strlen(adapter->pf_connection_name));
         }
         else
         {
-            strcpy_sec(ifreq.ifr_name,
-                       sizeof ifreq.ifr_name,
+            strcpy_sec(transport->ifreq.ifr_name,
+                       sizeof transport->ifreq.ifr_name,
                        adapter->connection_name,
                        strlen(adapter->connection_name));
         }
 
-        ifreq.ifr_data = (void *) ioctl_structure;
+        transport->is_open = TRUE;
+    } while(0);
 
-        /* Send request about data */
-        ioctl_structure->command = BASEDRIVER_WRITENVM_FUNCID;
-        debug_print_ioctl(ioctl_structure);
-        result = ioctl(socket_descriptor, ETHTOOL_IOCTL, &ifreq);
-        if(result < 0)
-        {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-            debug_ddp_print("Write error! Errno: %d ", errno);
-            break;
-        }
+    return status;
+}
 
-        /* Received data */
-        ioctl_structure->command = BASEDRIVER_READNVM_FUNCID;
-        result = ioctl(socket_descriptor, ETHTOOL_IOCTL, &ifreq);
-        if(result < 0)
-        {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-            debug_ddp_print("Read error! Errno: %d ", errno);
-        }
+/* Function close_ioctl_transport() releases the socket and the ioctl buffer of the adapter.
+ *
+ * Parameters:
+ * [in,out] adapter      Handle to current adapter
+ *
+ * Returns: None
+ */
+void
+close_ioctl_transport(adapter_t* adapter)
+{
+    ioctl_transport_t* transport = &adapter->transport;
 
-        debug_print_ioctl(ioctl_structure);
-    } while(0);
+    if(transport->is_open == TRUE)
+    {
+        debug_ddp_print("ioctl transport of %s closed after %d ioctl calls\n",
+                        transport->ifreq.ifr_name,
+                        transport->number_of_ioctls);
+        close(transport->socket_descriptor);
+    }
+    free_memory(transport->buffer);
+    MEMINIT(transport);
+}
 
-    errno = 0;
-    if(socket_descriptor >= 0)
+/* Function get_ioctl_buffer() returns the reusable ioctl buffer of the adapter, cleared and
+ * able to hold data_size bytes of data. The buffer grows when a bigger one is requested.
+ *
+ * Parameters:
+ * [in,out] adapter      Handle to current adapter
+ * [in]     data_size    Number of data bytes
+ *
+ * Returns: Handle to ioctl buffer or NULL if memory cannot be allocated.
+ */
+ioctl_structure_t*
+get_ioctl_buffer(adapter_t* adapter, uint32_t data_size)
+{
+    ioctl_transport_t* transport = &adapter->transport;
+    ioctl_structure_t* buffer    = NULL;
+
+    if(data_size > transport->buffer_size || transport->buffer == NULL)
+    {
+        buffer = malloc_sec(sizeof(ioctl_structure_t) + data_size - 1);
+        if(buffer == NULL)
+        {
+            return NULL;
+        }
+        free_memory(transport->buffer);
+        transport->buffer      = buffer;
+        transport->buffer_size = data_size;
+    }
+    else
     {
-        close(socket_descriptor);
+        memset(transport->buffer, 0, sizeof(ioctl_structure_t) + data_size - 1);
     }
 
-    return status;
+    return transport->buffer;
 }
 
+/* Function send_ioctl() sends a single ethtool ioctl through the transport of the adapter.
+ * errno of a failed ioctl is kept in the transport.
+ *
+ * Parameters:
+ * [in,out] adapter      Handle to current adapter
+ * [in,out] data         Handle to ioctl data
+ *
+ * Returns: DDP_SUCCESS or DDP_CANNOT_COMMUNICATE_ADAPTER.
+ */
 ddp_status_t
-execute_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor, uint16_t descriptor_size)
+send_ioctl(adapter_t* adapter, void* data)
 {
-    ioctl_structure_t* ioctl_data  = NULL;
-    ddp_status_t       status      = DDP_SUCCESS;
-    uint16_t           buffer_size = 0;
+    ddp_status_t status = DDP_SUCCESS;
 
     do
     {
-        if(descriptor == NULL)
+        status = open_ioctl_transport(adapter);
+        if(status != DDP_SUCCESS)
         {
-            status = DDP_INCORRECT_FUNCTION_PARAMETERS;
             break;
         }
 
-        /* preparing ioctl buffer - calculate size for data (ioctl + descriptor + adminq) */
-        buffer_size = sizeof(ioctl_structure_t) + descriptor_size - 1;
-        ioctl_data  = malloc_sec(buffer_size);
-        if(ioctl_data == NULL)
+        adapter->transport.ifreq.ifr_data = data;
+        adapter->transport.number_of_ioctls++;
+        adapter->transport.ioctl_errno = 0;
+        if(ioctl(adapter->transport.socket_descriptor, ETHTOOL_IOCTL, &adapter->transport.ifreq) < 0)
         {
-            status = DDP_ALLOCATE_MEMORY_FAIL;
-            break;
+            adapter->transport.ioctl_errno = errno;
+            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+        }
+    } while(0);
+
+    return status;
+}
+
+ddp_status_t
+get_data_by_basedriver(adapter_t* adapter, ioctl_structure_t* ioctl_structure)
+{
+    ddp_status_t status = DDP_SUCCESS;
+
+    do
+    {
+        if(adapter == NULL || ioctl_structure == NULL)
+        {
+            status = DDP_INCORRECT_FUNCTION_PARAMETERS;
+            break;
+        }
+
+        /* Send request about data */
+        ioctl_structure->command = BASEDRIVER_WRITENVM_FUNCID;
+        debug_print_ioctl(ioctl_structure);
+        status = send_ioctl(adapter, ioctl_structure);
+        if(status != DDP_SUCCESS)
+        {
+            debug_ddp_print("Write error! Errno: %d ", errno);
+            break;
+        }
+
+        /* Received data */
+        ioctl_structure->command = BASEDRIVER_READNVM_FUNCID;
+        status = send_ioctl(adapter, ioctl_structure);
+        if(status != DDP_SUCCESS)
+        {
+            debug_ddp_print("Read error! Errno: %d ", errno);
+        }
+
+        debug_print_ioctl(ioctl_structure);
+    } while(0);
+
+    errno = 0;
+
+    return status;
+}
+
+ddp_status_t
+execute_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor, uint16_t descriptor_size)
+{
+    ioctl_structure_t* ioctl_data  = NULL;
+    ddp_status_t       status      = DDP_SUCCESS;
+
+    do
+    {
+        if(adapter == NULL || descriptor == NULL || descriptor_size == 0)
+        {
+            status = DDP_INCORRECT_FUNCTION_PARAMETERS;
+            break;
+        }
+
+        /* preparing ioctl buffer - space for data (descriptor + adminq) */
+        ioctl_data = get_ioctl_buffer(adapter, descriptor_size);
+        if(ioctl_data == NULL)
+        {
+            status = DDP_ALLOCATE_MEMORY_FAIL;
+            break;
         }
 
         /* copy desciptor at end of ioctl_data strcuture */
@@ -668,20 +841,49 @@ execute_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor, uint16_t d
         }
     } while(0);
 
-    free(ioctl_data);
     return status;
 }
 
+/* Function prepare_register_access() fills the ioctl buffer of the adapter for register access.
+ *
+ * Parameters:
+ * [in,out] adapter      Handle to current adapter
+ * [in]     command      Read or write base driver command
+ * [in]     reg_address  Address of the register
+ * [in]     byte_number  Number of bytes to access
+ *
+ * Returns: Handle to ioctl buffer or NULL if memory cannot be allocated.
+ */
+ioctl_structure_t*
+prepare_register_access(adapter_t* adapter, uint32_t command, uint32_t reg_address, uint32_t byte_number)
+{
+    ioctl_structure_t* ioctl_data = get_ioctl_buffer(adapter, byte_number);
+
+    if(ioctl_data != NULL)
+    {
+        ioctl_data->command   = command;
+        ioctl_data->offset    = reg_address;
+        ioctl_data->data_size = byte_number;
+
+        /* set proper value for ioctl in accordance with function type (physical/virtual) */
+        if(adapter->is_virtual_function == TRUE && adapter->is_usable == TRUE)
+        {
+            ioctl_data->config = adapter->pf_device_id << 16 | IOCTL_REGISTER_ACCESS_COMMAND;
+        }
+        else
+        {
+            ioctl_data->config = adapter->device_id << 16 | IOCTL_REGISTER_ACCESS_COMMAND;
+        }
+    }
+
+    return ioctl_data;
+}
+
 ddp_status_t
 write_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, void* input_register)
 {
-    ifreq_t            ifreq;
-    ioctl_structure_t* ioctl_data        = NULL;
-    ddp_status_t       status            = DDP_SUCCESS;
-    int                result            = 0;
-    int                socket_descriptor = 0;
-
-    memset(&ifreq, 0, sizeof ifreq);
+    ioctl_structure_t* ioctl_data = NULL;
+    ddp_status_t       status     = DDP_SUCCESS;
 
     do
     {
@@ -692,71 +894,33 @@ write_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, v
             break;
         }
 
-        /* check socket descriptor */
-        socket_descriptor = socket(AF_INET, SOCK_DGRAM, 0);
-        if(socket_descriptor < 0)
-        {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-            break;
-        }
-
-        /* allocate memory for ioctl structure */
-        ioctl_data = malloc_sec(sizeof(ioctl_structure_t) + byte_number - 1);
+        /* set write parameters */
+        ioctl_data = prepare_register_access(adapter, BASEDRIVER_WRITENVM_FUNCID, reg_address, byte_number);
         if(ioctl_data == NULL)
         {
             status = DDP_ALLOCATE_MEMORY_FAIL;
             break;
         }
-
-        /* set write parameters */
-        ioctl_data->command   = BASEDRIVER_WRITENVM_FUNCID;
-        ioctl_data->offset    = reg_address;
-        ioctl_data->data_size = byte_number;
-        ifreq.ifr_data        = (void*)ioctl_data;
         memcpy_sec(&ioctl_data->data[0], byte_number, (uint8_t*)input_register, byte_number);
 
-        /* set proper value for ioctl in accordance with function type (physical/virtual) */
-        if(adapter->is_virtual_function == TRUE && adapter->is_usable == TRUE)
-        {
-            ioctl_data->config = adapter->pf_device_id << 16 | IOCTL_REGISTER_ACCESS_COMMAND;
-            strcpy_sec(ifreq.ifr_name, sizeof ifreq.ifr_name, adapter->pf_connection_name, strlen(adapter->pf_connection_name));
-        }
-        else
-        {
-            ioctl_data->config = adapter->device_id << 16 | IOCTL_REGISTER_ACCESS_COMMAND;
-            strcpy_sec(ifreq.ifr_name, sizeof ifreq.ifr_name, adapter->connection_name, strlen(adapter->connection_name));
-        }
-
         debug_print_ioctl(ioctl_data);
         /* send ioctl call */
-        result = ioctl(socket_descriptor, ETHTOOL_IOCTL, &ifreq);
-        if(result < 0)
+        status = send_ioctl(adapter, ioctl_data);
+        if(status != DDP_SUCCESS)
         {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             debug_ddp_print("Read error! Errno: %d\n", errno);
             break;
         }
     } while(0);
 
-    if(socket_descriptor >= 0)
-    {
-        close(socket_descriptor);
-    }
-    free_memory(ioctl_data);
-
     return status;
 }
 
 ddp_status_t
 read_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, void* output_register)
 {
-    ifreq_t            ifreq;
-    ioctl_structure_t* ioctl_data        = NULL;
-    ddp_status_t       status            = DDP_SUCCESS;
-    int                result            = 0;
-    int                socket_descriptor = 0;
-
-    memset(&ifreq, 0, sizeof ifreq);
+    ioctl_structure_t* ioctl_data = NULL;
+    ddp_status_t       status     = DDP_SUCCESS;
 
     do
     {
@@ -767,44 +931,18 @@ read_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, vo
             break;
         }
 
-        /* check socket descriptor */
-        socket_descriptor = socket(AF_INET, SOCK_DGRAM, 0);
-        if(socket_descriptor < 0)
-        {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-            break;
-        }
-
-        /* allocate memory for ioctl structure */
-        ioctl_data = malloc_sec(sizeof(ioctl_structure_t) + byte_number - 1);
+        /* set read parameters */
+        ioctl_data = prepare_register_access(adapter, BASEDRIVER_READNVM_FUNCID, reg_address, byte_number);
         if(ioctl_data == NULL)
         {
             status = DDP_ALLOCATE_MEMORY_FAIL;
             break;
         }
 
-        /* set write parameters */
-        ioctl_data->command   = BASEDRIVER_READNVM_FUNCID;
-        ioctl_data->offset    = reg_address;
-        ioctl_data->data_size = byte_number;
-        ifreq.ifr_data        = (void*)ioctl_data;
-        /* set proper value for ioctl in accordance with function type (physical/virtual) */
-        if(adapter->is_virtual_function == TRUE && adapter->is_usable == TRUE)
-        {
-            ioctl_data->config = adapter->pf_device_id << 16 | IOCTL_REGISTER_ACCESS_COMMAND;
-            strcpy_sec(ifreq.ifr_name, sizeof ifreq.ifr_name, adapter->pf_connection_name, strlen(adapter->pf_connection_name));
-        }
-        else
-        {
-            ioctl_data->config = adapter->device_id << 16 | IOCTL_REGISTER_ACCESS_COMMAND;
-            strcpy_sec(ifreq.ifr_name, sizeof ifreq.ifr_name, adapter->connection_name, strlen(adapter->connection_name));
-        }
-
         /* send ioctl call */
-        result = ioctl(socket_descriptor, ETHTOOL_IOCTL, &ifreq);
-        if(result < 0)
+        status = send_ioctl(adapter, ioctl_data);
+        if(status != DDP_SUCCESS)
         {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             debug_ddp_print("Read error! Errno: %d\n", errno);
             break;
         }
@@ -813,60 +951,151 @@ read_register(adapter_t* adapter, uint32_t reg_address, uint32_t byte_number, vo
         memcpy_sec((void*)output_register, byte_number, &ioctl_data->data[0], byte_number);
     } while(0);
 
-    if(socket_descriptor >= 0)
-    {
-        close(socket_descriptor);
-    }
-    free_memory(ioctl_data);
-
     return status;
 }
 
-ddp_status_t
-get_driver_info(adapter_t* adapter, driver_info_t* driver_info)
+/* Function is_bulk_access_rejected() checks if the last register access failed because base
+ * driver does not support multi-dword access.
+ *
+ * Parameters:
+ * [in] adapter  Handle to current adapter
+ *
+ * Returns: TRUE if multi-dword access was rejected, FALSE otherwise.
+ */
+bool
+is_bulk_access_rejected(adapter_t* adapter)
 {
-    ifreq_t      ifreq;
-    ddp_status_t status            = DDP_SUCCESS;
-    int          result            = 0;
-    int          socket_descriptor = 0;
+    return (adapter->transport.ioctl_errno == EINVAL || adapter->transport.ioctl_errno == EOPNOTSUPP) ? TRUE : FALSE;
+}
 
-    memset(&ifreq, 0, sizeof ifreq);
+/* Function write_registers() writes contiguous range of dword registers. The whole range is
+ * sent in a single ioctl, if base driver rejects multi-dword access (EINVAL or EOPNOTSUPP) the
+ * range is written dword by dword and bulk access is not tried again for the adapter. Other
+ * errors are returned.
+ *
+ * Parameters:
+ * [in,out] adapter          Handle to current adapter
+ * [in]     reg_address      Address of the first register
+ * [in]     dword_count      Number of registers
+ * [in]     input_registers  Values of registers
+ *
+ * Returns: DDP status.
+ */
+ddp_status_t
+write_registers(adapter_t* adapter, uint32_t reg_address, uint32_t dword_count, void* input_registers)
+{
+    uint8_t*     input  = (uint8_t*)input_registers;
+    ddp_status_t status = DDP_SUCCESS;
+    uint32_t     i      = 0;
 
     do
     {
-        if(adapter == NULL || driver_info == NULL)
+        if(adapter == NULL || input_registers == NULL || dword_count == 0)
         {
             status = DDP_INCORRECT_FUNCTION_PARAMETERS;
             break;
         }
 
-        socket_descriptor = socket(AF_INET, SOCK_DGRAM, 0);
-        if(socket_descriptor < 0)
+        if(dword_count > 1 && adapter->transport.bulk_access_unsupported == FALSE)
         {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+            status = write_register(adapter, reg_address, dword_count * DDP_DWORD_LENGTH, input);
+            if(status == DDP_SUCCESS || is_bulk_access_rejected(adapter) == FALSE)
+            {
+                break;
+            }
+            debug_ddp_print("Bulk register access rejected, using single dword access\n");
+            adapter->transport.bulk_access_unsupported = TRUE;
+        }
+
+        for(i = 0; i < dword_count; i++)
+        {
+            status = write_register(adapter,
+                                    reg_address + i * DDP_DWORD_LENGTH,
+                                    DDP_DWORD_LENGTH,
+                                    &input[i * DDP_DWORD_LENGTH]);
+            if(status != DDP_SUCCESS)
+            {
+                break;
+            }
+        }
+    } while(0);
+
+    return status;
+}
+
+/* Function read_registers() reads contiguous range of dword registers. The whole range is
+ * read in a single ioctl, if base driver rejects multi-dword access (EINVAL or EOPNOTSUPP) the
+ * range is read dword by dword and bulk access is not tried again for the adapter. Other
+ * errors are returned.
+ *
+ * Parameters:
+ * [in,out] adapter           Handle to current adapter
+ * [in]     reg_address       Address of the first register
+ * [in]     dword_count       Number of registers
+ * [out]    output_registers  Buffer for values of registers
+ *
+ * Returns: DDP status.
+ */
+ddp_status_t
+read_registers(adapter_t* adapter, uint32_t reg_address, uint32_t dword_count, void* output_registers)
+{
+    uint8_t*     output = (uint8_t*)output_registers;
+    ddp_status_t status = DDP_SUCCESS;
+    uint32_t     i      = 0;
+
+    do
+    {
+        if(adapter == NULL || output_registers == NULL || dword_count == 0)
+        {
+            status = DDP_INCORRECT_FUNCTION_PARAMETERS;
             break;
         }
 
-        if(adapter->is_virtual_function == TRUE &&
-           adapter->is_usable == TRUE)
+        if(dword_count > 1 && adapter->transport.bulk_access_unsupported == FALSE)
         {
-            /* for virtual functions we need a connection name from PF */
-            strcpy_sec(ifreq.ifr_name, sizeof ifreq.ifr_name, adapter->pf_connection_name, strlen(adapter->pf_connection_name));
+            status = read_register(adapter, reg_address, dword_count * DDP_DWORD_LENGTH, output);
+            if(status == DDP_SUCCESS || is_bulk_access_rejected(adapter) == FALSE)
+            {
+                break;
+            }
+            debug_ddp_print("Bulk register access rejected, using single dword access\n");
+            adapter->transport.bulk_access_unsupported = TRUE;
         }
-        else
+
+        for(i = 0; i < dword_count; i++)
         {
-            strcpy_sec(ifreq.ifr_name, sizeof ifreq.ifr_name, adapter->connection_name, strlen(adapter->connection_name));
+            status = read_register(adapter,
+                                   reg_address + i * DDP_DWORD_LENGTH,
+                                   DDP_DWORD_LENGTH,
+                                   &output[i * DDP_DWORD_LENGTH]);
+            if(status != DDP_SUCCESS)
+            {
+                break;
+            }
         }
+    } while(0);
 
+    return status;
+}
+
+ddp_status_t
+get_driver_info(adapter_t* adapter, driver_info_t* driver_info)
+{
+    ddp_status_t status = DDP_SUCCESS;
 
-        ifreq.ifr_data = (void *) driver_info;
+    do
+    {
+        if(adapter == NULL || driver_info == NULL)
+        {
+            status = DDP_INCORRECT_FUNCTION_PARAMETERS;
+            break;
+        }
 
         /* Send request about data */
         driver_info->command = ETHTOOL_GDRVINFO;
-        result = ioctl(socket_descriptor, ETHTOOL_IOCTL, &ifreq);
-        if(result < 0)
+        status = send_ioctl(adapter, driver_info);
+        if(status != DDP_SUCCESS)
         {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             debug_ddp_print("Write error! Errno: %d ", errno);
             break;
         }
@@ -875,10 +1104,6 @@ get_driver_info(adapter_t* adapter, driver_info_t* driver_info)
     } while(0);
 
     errno = 0;
-    if(socket_descriptor >= 0)
-    {
-        close(socket_descriptor);
-    }
 
     return status;
 }
@@ -888,6 +1113,7 @@ get_nvm_version(adapter_t* adapter, nvm_version_t* nvm_version)
 {
     driver_info_t driver_info;
     char*         version_string = NULL;
+    char*         save_pointer   = NULL;
     ddp_status_t  status         = DDP_SUCCESS;
 
     memset(&driver_info, 0, sizeof driver_info);
@@ -906,7 +1132,7 @@ get_nvm_version(adapter_t* adapter, nvm_version_t* nvm_version)
          * NVM_version_major.NVM_version_minor 0xETrackID CIVD_build.CIVD_major.CIVD_minor */
 
         /* Get NVM version major */
-        version_string = strtok(driver_info.firmware_version, ". ");
+        version_string = strtok_r(driver_info.firmware_version, ". ", &save_pointer);
         if(version_string == NULL)
         {
             status = DDP_CANNOT_READ_DEVICE_DATA;
@@ -915,7 +1141,7 @@ get_nvm_version(adapter_t* adapter, nvm_version_t* nvm_version)
         nvm_version->nvm_version_major = (uint8_t)(strtol(driver_info.firmware_version, &version_string, DDP_HEXADECIMAL_SYSTEM));
 
         /* Get NVM version minor */
-        version_string = strtok(NULL, ". ");
+        version_string = strtok_r(NULL, ". ", &save_pointer);
         if(version_string == NULL)
         {
             status = DDP_CANNOT_READ_DEVICE_DATA;
@@ -1030,197 +1256,840 @@ discovery_device(adapter_t* adapter)
         status = adapter->tdi.discovery_device(adapter);
     }
 
+    /* ioctl transport is kept only for the time of the discovery */
+    close_ioctl_transport(adapter);
+
     return status;
 }
 
-ddp_status_t
-discovery_devices(list_t adapter_list)
+/* Function discovery_worker() is the body of a discovery worker thread. Each worker
+ * takes the next pending job from the shared pool and runs the family specific
+ * discovery for it until the pool is drained. The ice batch counts as one job - the
+ * first worker runs it, while the others take the remaining jobs.
+ *
+ * Parameters:
+ * [in,out] context      Handle to discovery pool
+ *
+ * Returns: NULL
+ */
+void*
+discovery_worker(void* context)
 {
-    node_t*         adapter_node      = get_node(&adapter_list);
-    ddp_status_t    status            = DDP_INCORRECT_FUNCTION_PARAMETERS;
-    ddp_status_t    function_status   = DDP_INCORRECT_FUNCTION_PARAMETERS;
-    adapter_t*      adapter           = NULL;
-    adapter_t*      previous_adapter  = NULL;
-    bool            is_profile_loaded = FALSE;
-
-    while(adapter_node != NULL)
+    discovery_pool_t* pool      = (discovery_pool_t*)context;
+    discovery_job_t*  job       = NULL;
+    uint32_t          job_index = 0;
+    bool              run_batch = FALSE;
+
+    while(TRUE)
     {
-        adapter = get_adapter_from_list_node(adapter_node);
-        if(adapter == NULL)
+        pthread_mutex_lock(&pool->lock);
+        run_batch = pool->batch_pending;
+        pool->batch_pending = FALSE;
+        if(run_batch == FALSE)
+        {
+            job_index = pool->next_job++;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        if(run_batch == TRUE)
+        {
+            ice_run_discovery_batch(pool->jobs, pool->number_of_jobs);
+            continue;
+        }
+
+        if(job_index >= pool->number_of_jobs)
+        {
+            break;
+        }
+
+        job = &pool->jobs[job_index];
+        if(job->adapter == NULL || job->copy_from_previous == TRUE || job->is_done == TRUE ||
+           job->is_batched == TRUE || job->adapter->selector_status != DDP_SUCCESS)
+        {
+            continue;
+        }
+
+        job->status = discovery_device(job->adapter);
+    }
+
+    return NULL;
+}
+
+/* Function run_discovery_pool() executes all jobs from the pool using up to
+ * thread_count workers. The calling thread is one of the workers, so if a thread
+ * cannot be created the remaining jobs are still processed.
+ *
+ * Parameters:
+ * [in,out] pool          Handle to discovery pool
+ * [in]     thread_count  Maximum number of workers
+ *
+ * Returns: None
+ */
+void
+run_discovery_pool(discovery_pool_t* pool, uint32_t thread_count)
+{
+    pthread_t* threads = NULL;
+    uint32_t   created = 0;
+    uint32_t   i       = 0;
+    int        result  = 0;
+
+    do
+    {
+        if(thread_count <= 1)
+        {
+            break;
+        }
+
+        threads = malloc_sec(sizeof(pthread_t) * (thread_count - 1));
+        if(threads == NULL)
+        {
+            debug_ddp_print("Cannot allocate discovery threads, running serially\n");
+            break;
+        }
+
+        for(i = 0; i < thread_count - 1; i++)
+        {
+            result = pthread_create(&threads[created], NULL, discovery_worker, pool);
+            if(result != 0)
+            {
+                debug_ddp_print("pthread_create error: %d\n", result);
+                break;
+            }
+            created++;
+        }
+    } while(0);
+
+    discovery_worker(pool);
+
+    for(i = 0; i < created; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    debug_ddp_print("Discovery executed by %d worker(s)\n", created + 1);
+    free_memory(threads);
+}
+
+ddp_status_t
+discovery_devices(list_t adapter_list)
+{
+    discovery_pool_t pool;
+    node_t*          adapter_node      = get_node(&adapter_list);
+    ddp_status_t     status            = DDP_INCORRECT_FUNCTION_PARAMETERS;
+    ddp_status_t     function_status   = DDP_INCORRECT_FUNCTION_PARAMETERS;
+    adapter_t*       adapter           = NULL;
+    adapter_t*       previous_adapter  = NULL;
+    uint32_t         pending_jobs      = 0;
+    uint32_t         batched_jobs      = 0;
+    uint32_t         thread_count      = get_discovery_thread_count();
+    uint32_t         i                 = 0;
+    bool             is_profile_loaded = FALSE;
+
+    MEMINIT(&pool);
+
+    do
+    {
+        pool.jobs = malloc_sec(sizeof(discovery_job_t) * adapter_list.number_of_nodes);
+        if(pool.jobs == NULL)
+        {
+            status = DDP_ALLOCATE_MEMORY_FAIL;
+            break;
+        }
+
+        /* build jobs in list (BDF) order */
+        for(i = 0; adapter_node != NULL && i < adapter_list.number_of_nodes; i++)
+        {
+            adapter = get_adapter_from_list_node(adapter_node);
+            pool.jobs[i].adapter = adapter;
+            if(adapter != NULL &&
+               previous_adapter != NULL &&
+               previous_adapter->is_usable == TRUE &&
+               COMPARE_PCI_LOCATION(adapter, previous_adapter) == TRUE)
+            {
+                pool.jobs[i].copy_from_previous = TRUE;
+            }
+            else if(adapter != NULL && adapter->selector_status == DDP_SUCCESS)
+            {
+                pending_jobs++;
+            }
+
+            adapter_node = get_next_node(adapter_node);
+            previous_adapter = adapter;
+        }
+        pool.number_of_jobs = i;
+
+        /* ice adapters reported by the DevLink dump are discovered from it. Adapters accessible only by
+         * IOCTL are claimed by the ice batch - their adminQ commands are interleaved in one pool job.
+         * Adapters queried by own DevLink descriptor stay pending for the workers. */
+        batched_jobs = ice_prepare_discovery_batch(pool.jobs, pool.number_of_jobs);
+        for(i = 0; i < pool.number_of_jobs; i++)
+        {
+            if(pool.jobs[i].is_done == TRUE || pool.jobs[i].is_batched == TRUE)
+            {
+                pending_jobs--;
+            }
+        }
+        if(batched_jobs > 0)
+        {
+            pool.batch_pending = TRUE;
+            pending_jobs++;
+        }
+
+        if(thread_count > pending_jobs)
+        {
+            thread_count = pending_jobs;
+        }
+
+        pthread_mutex_init(&pool.lock, NULL);
+        run_discovery_pool(&pool, thread_count);
+        pthread_mutex_destroy(&pool.lock);
+
+        /* join results in list order */
+        for(i = 0; i < pool.number_of_jobs; i++)
+        {
+            adapter = pool.jobs[i].adapter;
+            if(adapter == NULL)
+            {
+                status = DDP_CANNOT_READ_DEVICE_DATA;
+                continue;
+            }
+            if(adapter->selector_status != DDP_SUCCESS)
+            {
+                /* not resolved selector - already reported by generate_adapter_list() */
+                continue;
+            }
+
+            if(pool.jobs[i].copy_from_previous == TRUE)
+            {
+                memcpy_sec(&adapter->profile_info,
+                           sizeof(profile_info_t),
+                           &pool.jobs[i - 1].adapter->profile_info,
+                           sizeof(profile_info_t));
+            }
+            else
+            {
+                function_status = pool.jobs[i].status;
+                if(function_status == DDP_SUCCESS && is_profile_loaded == FALSE)
+                {
+                    is_profile_loaded = TRUE;
+                }
+                else if(function_status == DDP_NO_DDP_PROFILE && is_profile_loaded == TRUE)
+                {
+                    function_status = DDP_SUCCESS;
+                }
+                else if(function_status != DDP_SUCCESS)
+                {
+                    status = function_status;
+                }
+            }
+        }
+
+        if(function_status == DDP_SUCCESS)
+        {
+            status = function_status;
+        }
+    } while(0);
+
+    free_memory(pool.jobs);
+
+    return status;
+}
+
+void
+print_help(void)
+{
+    /*      ********* 10 ****** 20 ****** 30 ****** 40 ****** 50 ****** 60 ****** 70 ******/
+    printf("Usage: ddptool [parameters] [argument]\n");
+    printf("    -a                  Display information about all functions for all\n"
+           "                        supported devices\n");
+    printf("    -h, --help, -?      Display command line help\n");
+    printf("    -i DEVNAME          Display information for the specified network\n"
+           "                        interface name. May be repeated or contain a comma\n"
+           "                        separated list of names\n");
+    printf("    -j [FILENAME]       Output in JSON format to a file. If [FILENAME] is not\n"
+           "                        specified, output is sent to standard output.\n");
+    printf("    -l                  Silent mode\n");
+    printf("    -s dddd:bb:ss.f     Display information about the device located at the\n"
+           "                        specified PCI location, (where d - domain, b - bus,\n"
+           "                        s - slot, f - function, all numbers are in hex).\n"
+           "                        May be repeated or contain a comma separated list\n");
+    printf("    --selectors-file FILENAME\n"
+           "                        Read PCI locations and interface names from file\n"
+           "                        (one entry per selector is displayed)\n");
+    printf("    -t THREADS          Number of worker threads used to discover devices\n"
+           "                        in parallel (1 - %d, default %d)\n",
+           DDP_MAX_DISCOVERY_THREADS,
+           DDP_DEFAULT_DISCOVERY_THREADS);
+    printf("    -v                  Prints version of DDP tool\n");
+    printf("    -x [FILENAME]       Output in XML format to a file. If [FILENAME] is not\n"
+           "                        specified, output is sent to standard output\n");
+    printf("    -f [FILENAME]       Displays information about the profile contained\n"
+           "                        in the specified package file\n");
+    printf("    --dump-region %s|%s\n"
+           "                        Dump NVM flash or device capabilities region of\n"
+           "                        the device selected by '-s' or '-i' (DevLink only)\n",
+           DDP_DUMP_REGION_FLASH,
+           DDP_DUMP_REGION_CAPS);
+    printf("    --dump-file FILENAME\n"
+           "                        Write region dump to a file. If not specified, dump\n"
+           "                        is sent to standard output\n");
+}
+
+void
+print_header()
+{
+    /* for silent mode tool shouldn't print anything on screen  */
+    if(check_command_parameter(DDP_SILENT_MODE_PARAMETER_BIT))
+        return;
+
+    /* region dump sent to standard output cannot be mixed with text */
+    if(check_command_parameter(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT) == TRUE &&
+       check_command_parameter(DDP_DUMP_FILE_COMMAND_PARAMETER_BIT) == FALSE)
+        return;
+
+    printf("Intel(R) Dynamic Device Personalization Tool\n");
+    printf("DDPTool version %d.%d.%d.%d\n",
+           DDP_MAJOR_VERSION,
+           DDP_MINOR_VERSION,
+           DDP_BUILD_VERSION,
+           DDP_FIX_VERSION);
+    printf("Copyright (C) 2019 - %d Intel Corporation.\n\n", DDP_COPYRIGHT_DATE);
+}
+
+ddp_status_t
+get_device_identifier(adapter_t* adapter)
+{
+    ddp_status_t status = DDP_SUCCESS;
+
+    do
+    {
+        /* try read data from pci config space */
+        status = get_data_from_sysfs_config(adapter);
+        /* if function returns SUCCESS and deviceId/vendorId are incorrect, tool needs read 4-PartId using other method */
+        if(status == DDP_SUCCESS && adapter->vendor_id != 0xFFFF && adapter->device_id != 0xFFFF)
+        {
+            break;
+        }
+
+        get_data_from_sysfs_files(adapter);
+    } while(0);
+
+    return status;
+}
+
+ddp_status_t
+initialize_adapter(adapter_t* adapter)
+{
+    ddp_status_t status = DDP_SUCCESS;
+
+    switch(adapter->adapter_family)
+    {
+    case family_40G:
+        i40e_initialize_device(adapter);
+        break;
+    case family_100G: /* fall-through */
+    case family_100G_SW:
+    case family_100G_SWX:
+        ice_initialize_device(adapter);
+        break;
+    case family_none:
+    case family_last:
+        /* fall-through */
+    default:
+        adapter->tdi.discovery_device     = NULL;
+        adapter->tdi.is_virtual_function  = NULL;
+        status = DDP_INCORRECT_FUNCTION_PARAMETERS;
+        break;
+    }
+
+    return status;
+}
+
+ddp_status_t
+generate_dummy_adapter_list(list_t* adapter_list)
+{
+    adapter_t*   dummy_adapter = NULL;
+    ddp_status_t status        = DDP_SUCCESS;
+
+    do
+    {
+        dummy_adapter = arena_malloc(sizeof(adapter_t));
+        if(dummy_adapter == NULL)
+        {
+            break;
+        }
+
+        status = add_node_data(adapter_list, (void*) dummy_adapter, sizeof(adapter_t));
+        if(status != DDP_SUCCESS)
+        {
+            break;
+        }
+    } while (0);
+
+    return status;
+}
+
+/* Function probe_device() runs the full probing of a single PCI function - reads its
+ * identifiers, verifies driver support, initializes family specific interface and
+ * reads the connection name.
+ *
+ * Parameters:
+ * [in,out] device           Handle to adapter with PCI location set
+ * [in]     physical_device  Handle to physical function used for virtual functions
+ *                           (may be NULL)
+ * [out]    is_listed        TRUE if the device shall be added to the adapter list
+ *
+ * Returns: DDP_SUCCESS or error code for devices which cannot be used.
+ */
+ddp_status_t
+probe_device(adapter_t* device, adapter_t* physical_device, bool* is_listed)
+{
+    ddp_status_t status          = DDP_SUCCESS;
+    ddp_status_t function_status = DDP_SUCCESS;
+    bool         is_vf           = FALSE;
+
+    *is_listed = FALSE;
+
+    do
+    {
+        status = get_device_identifier(device);
+        if(status != DDP_SUCCESS)
+        {
+            debug_ddp_print("get_device_identifier error: 0x%X\n", status);
+            break;
+        }
+
+        if(is_device_supported(device) == FALSE)
+        {
+            break;
+        }
+        debug_ddp_print("Device location: %04x:%02x:%02x.%x\n",
+                        device->location.segment,
+                        device->location.bus,
+                        device->location.device,
+                        device->location.function);
+
+        /* if the device is supported - verify if the associated driver is available/supported */
+        if(Global_driver_os_ctx[device->adapter_family].driver_available == FALSE)
+        {
+            status = DDP_NO_BASE_DRIVER;
+            debug_ddp_print("No base driver.\n");
+            break;
+        }
+        if(Global_driver_os_ctx[device->adapter_family].driver_supported == FALSE)
+        {
+            status = DDP_UNSUPPORTED_BASE_DRIVER;
+            debug_ddp_print("Base driver not supported.\n");
+            break;
+        }
+
+        /* Initialize created node */
+        function_status = initialize_adapter(device);
+        if(function_status != DDP_SUCCESS)
+        {
+            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+            break;
+        }
+
+        is_vf = is_virtual_function(device);
+        if(is_vf == TRUE)
+        {
+            if(check_command_parameter(DDP_ALL_ADAPTERS_PARAMETER_BIT) == FALSE)
+            {
+                /* only with parameter -a tool works with virtual functions*/
+                break;
+            }
+
+            device->is_virtual_function = TRUE;
+            device->is_usable = FALSE; /* virtual function cannot be use for communicate with base driver */
+
+            if(physical_device != NULL && physical_device->is_usable == TRUE)
+            {
+                strcpy_sec(device->pf_connection_name,
+                           sizeof(device->pf_connection_name),
+                           physical_device->connection_name,
+                           strlen(physical_device->connection_name)); /* need for getting data by base driver */
+                memcpy_sec(&device->pf_location,
+                           sizeof(device->pf_location),
+                           &physical_device->location,
+                           sizeof(physical_device->location));
+                device->pf_device_id = physical_device->device_id;
+                device->is_usable = TRUE; /* it's true if we have a connection name from physical function */
+            }
+        }
+
+        function_status = get_connection_name(device);
+        if(function_status == DDP_SUCCESS)
+        {
+            device->is_usable = TRUE;
+        }
+        else
+        {
+            /* if the driver did not write connection name to sysfs
+             * we cannot use ioctl to communicate with that function */
+            device->is_usable = FALSE;
+            debug_ddp_print("get_connection_name error: 0x%X\n", function_status);
+            /* the adapter must be added to the adapter list, so the tool cannot skip this device */
+        }
+
+        *is_listed = TRUE;
+    } while(0);
+
+    return status;
+}
+
+ddp_status_t
+add_adapter_to_list(list_t* adapter_list, adapter_t* device)
+{
+    adapter_t*   adapter = NULL;
+    ddp_status_t status  = DDP_SUCCESS;
+
+    do
+    {
+        adapter = arena_malloc(sizeof(adapter_t));
+        if(adapter == NULL)
+        {
+            status = DDP_ALLOCATE_MEMORY_FAIL;
+            break;
+        }
+        memcpy_sec(adapter, sizeof(adapter_t), device, sizeof(adapter_t));
+
+        /* Add node to the list */
+        debug_ddp_print("Adding to list device: 0x%X:0x%X:0x%X.0x%X\n",
+                        adapter->location.segment,
+                        adapter->location.bus,
+                        adapter->location.device,
+                        adapter->location.function);
+        status = add_node_data(adapter_list, (void*)adapter, sizeof(adapter_t));
+    } while(0);
+
+    return status;
+}
+
+/* Function get_location_from_link() reads a sysfs link pointing to a PCI device
+ * directory and returns the PCI location string of that device.
+ *
+ * Parameters:
+ * [in]  path_to_link      Path to the link
+ * [out] location_string   Buffer for location string (at least PCI_LOCATION_STRING_SIZE + 1)
+ * [out] location          PCI location parsed from the link
+ *
+ * Returns: DDP_SUCCESS if link points to a PCI device, error code otherwise.
+ */
+ddp_status_t
+get_location_from_link(char* path_to_link, char* location_string, device_location_t* location)
+{
+    char         link[DDP_MAX_BUFFER_SIZE];
+    char*        name            = NULL;
+    ssize_t      readlink_result = 0;
+    ddp_status_t status          = DDP_SUCCESS;
+
+    memset(link, '\0', sizeof(link));
+
+    do
+    {
+        readlink_result = readlink(path_to_link, link, sizeof(link) - 1);
+        if(readlink_result <= 0 || readlink_result == sizeof(link) - 1)
+        {
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
+        }
+
+        name = strrchr(link, '/');
+        name = (name == NULL) ? link : name + 1;
+        if(strlen(name) != PCI_LOCATION_STRING_SIZE)
+        {
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
+        }
+
+        if(sscanf(name,
+                  "%04hx:%02hx:%02hx.%hx",
+                  &location->segment,
+                  &location->bus,
+                  &location->device,
+                  &location->function) != 4)
+        {
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
+        }
+
+        status = strcpy_sec(location_string, PCI_LOCATION_STRING_SIZE + 1, name, PCI_LOCATION_STRING_SIZE);
+    } while(0);
+
+    return status;
+}
+
+/* Function generate_adapter_by_location() probes only the PCI function at the given
+ * location (and its parent physical function for virtual functions) and adds it to
+ * the adapter list. The cost doesn't depend on the number of PCI devices in the system.
+ *
+ * Parameters:
+ * [in,out] adapter_list     Handle to adapter list
+ * [in]     location_string  PCI location in dddd:bb:ss.f format
+ * [in]     interface_name   Expected connection name or NULL
+ *
+ * Returns: DDP_SUCCESS if device was added, error code otherwise.
+ */
+ddp_status_t
+generate_adapter_by_location(list_t* adapter_list, char* location_string, char* interface_name)
+{
+    adapter_t    current_device;
+    adapter_t    physical_device;
+    char         path_to_device[DDP_MAX_BUFFER_SIZE];
+    char         pf_location_string[PCI_LOCATION_STRING_SIZE + 1];
+    struct stat  node_attributes                                  = {0};
+    ddp_status_t status                                           = DDP_SUCCESS;
+    ddp_status_t function_status                                  = DDP_SUCCESS;
+    bool         is_listed                                        = FALSE;
+    bool         is_pf_probed                                     = FALSE;
+
+    MEMINIT(&current_device);
+    MEMINIT(&physical_device);
+    MEMINIT(&path_to_device);
+    MEMINIT(&pf_location_string);
+
+    do
+    {
+        if(location_string == NULL || strlen(location_string) != PCI_LOCATION_STRING_SIZE)
+        {
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
+        }
+
+        if(sscanf(location_string,
+                  "%04hx:%02hx:%02hx.%hx",
+                  &current_device.location.segment,
+                  &current_device.location.bus,
+                  &current_device.location.device,
+                  &current_device.location.function) != 4)
+        {
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
+        }
+
+        snprintf(path_to_device, sizeof(path_to_device), "%s%s", PATH_TO_SYSFS_PCI, location_string);
+        if(stat(path_to_device, &node_attributes) != 0 || S_ISDIR(node_attributes.st_mode) == FALSE)
+        {
+            debug_ddp_print("Device %s doesn't exist\n", location_string);
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
+        }
+
+        /* virtual function - probe parent physical function first */
+        strcat_sec(path_to_device, sizeof(path_to_device), "/physfn", strlen("/physfn"));
+        function_status = get_location_from_link(path_to_device, pf_location_string, &physical_device.location);
+        if(function_status == DDP_SUCCESS)
         {
-            status = DDP_CANNOT_READ_DEVICE_DATA;
-            continue;
+            function_status = probe_device(&physical_device, NULL, &is_listed);
+            debug_ddp_print("Parent PF %s probe status: 0x%X\n", pf_location_string, function_status);
+            is_pf_probed = TRUE;
         }
 
-        if(previous_adapter != NULL &&
-           previous_adapter->is_usable == TRUE &&
-           COMPARE_PCI_LOCATION(adapter, previous_adapter) == TRUE)
+        status = probe_device(&current_device, is_pf_probed == TRUE ? &physical_device : NULL, &is_listed);
+        if(status != DDP_SUCCESS)
         {
-            memcpy_sec(&adapter->profile_info,
-                       sizeof(profile_info_t),
-                       &previous_adapter->profile_info,
-                       sizeof(profile_info_t));
+            break;
         }
-        else
+        if(is_listed == FALSE ||
+           (interface_name != NULL && strcmp(interface_name, current_device.connection_name) != 0))
         {
-            function_status = discovery_device(adapter);
-            if(function_status == DDP_SUCCESS && is_profile_loaded == FALSE)
-            {
-                is_profile_loaded = TRUE;
-            }
-            else if(function_status == DDP_NO_DDP_PROFILE && is_profile_loaded == TRUE)
-            {
-                function_status = DDP_SUCCESS;
-            }
-            else if(function_status != DDP_SUCCESS)
-            {
-                status = function_status;
-            }
+            status = DDP_DEVICE_NOT_FOUND;
+            break;
         }
 
-        adapter_node = get_next_node(adapter_node);
-        previous_adapter = adapter;
-    }
+        status = add_adapter_to_list(adapter_list, &current_device);
+        if(status == DDP_SUCCESS)
+        {
+            /* branding string is owned by the list now */
+            current_device.branding_string_allocated = FALSE;
+        }
+    } while(0);
 
-    if(function_status == DDP_SUCCESS)
+    if(current_device.branding_string_allocated == TRUE)
     {
-        status = function_status;
+        free_memory(current_device.branding_string);
+    }
+    if(physical_device.branding_string_allocated == TRUE)
+    {
+        free_memory(physical_device.branding_string);
     }
 
     return status;
 }
 
-void
-print_help(void)
-{
-    /*      ********* 10 ****** 20 ****** 30 ****** 40 ****** 50 ****** 60 ****** 70 ******/
-    printf("Usage: ddptool [parameters] [argument]\n");
-    printf("    -a                  Display information about all functions for all\n"
-           "                        supported devices\n");
-    printf("    -h, --help, -?      Display command line help\n");
-    printf("    -i DEVNAME          Display information for the specified network\n"
-           "                        interface name\n");
-    printf("    -j [FILENAME]       Output in JSON format to a file. If [FILENAME] is not\n"
-           "                        specified, output is sent to standard output.\n");
-    printf("    -l                  Silent mode\n");
-    printf("    -s dddd:bb:ss.f     Display information about the device located at the\n"
-           "                        specified PCI location, (where d - domain, b - bus,\n"
-           "                        s - slot, f - function, all numbers are in hex)\n");
-    printf("    -v                  Prints version of DDP tool\n");
-    printf("    -x [FILENAME]       Output in XML format to a file. If [FILENAME] is not\n"
-           "                        specified, output is sent to standard output\n");
-    printf("    -f [FILENAME]       Displays information about the profile contained\n"
-           "                        in the specified package file\n");
-}
-
-void
-print_header()
-{
-    /* for silent mode tool shouldn't print anything on screen  */
-    if(check_command_parameter(DDP_SILENT_MODE_PARAMETER_BIT))
-        return;
-
-    printf("Intel(R) Dynamic Device Personalization Tool\n");
-    printf("DDPTool version %d.%d.%d.%d\n",
-           DDP_MAJOR_VERSION,
-           DDP_MINOR_VERSION,
-           DDP_BUILD_VERSION,
-           DDP_FIX_VERSION);
-    printf("Copyright (C) 2019 - %d Intel Corporation.\n\n", DDP_COPYRIGHT_DATE);
-}
-
+/* Function generate_adapter_by_interface() resolves the network interface name to
+ * the PCI location using /sys/class/net/<if>/device and probes only that function.
+ *
+ * Parameters:
+ * [in,out] adapter_list     Handle to adapter list
+ * [in]     interface_name   Network interface name
+ *
+ * Returns: DDP_SUCCESS if device was added, error code otherwise.
+ */
 ddp_status_t
-get_device_identifier(adapter_t* adapter)
+generate_adapter_by_interface(list_t* adapter_list, char* interface_name)
 {
-    ddp_status_t status = DDP_SUCCESS;
+    char              path_to_link[DDP_MAX_BUFFER_SIZE];
+    char              location_string[PCI_LOCATION_STRING_SIZE + 1];
+    device_location_t location;
+    ddp_status_t      status                                       = DDP_SUCCESS;
+
+    MEMINIT(&path_to_link);
+    MEMINIT(&location_string);
+    MEMINIT(&location);
 
     do
     {
-        /* try read data from pci config space */
-        status = get_data_from_sysfs_config(adapter);
-        /* if function returns SUCCESS and deviceId/vendorId are incorrect, tool needs read 4-PartId using other method */
-        if(status == DDP_SUCCESS && adapter->vendor_id != 0xFFFF && adapter->device_id != 0xFFFF)
+        if(interface_name == NULL || strlen(interface_name) == 0 || strlen(interface_name) >= IFNAMSIZ ||
+           strchr(interface_name, '/') != NULL)
         {
+            status = DDP_DEVICE_NOT_FOUND;
             break;
         }
 
-        get_data_from_sysfs_files(adapter);
+        snprintf(path_to_link, sizeof(path_to_link), "%s%s/device", PATH_TO_SYSFS_NET, interface_name);
+        status = get_location_from_link(path_to_link, location_string, &location);
+        if(status != DDP_SUCCESS)
+        {
+            debug_ddp_print("Cannot resolve interface %s\n", interface_name);
+            break;
+        }
+
+        status = generate_adapter_by_location(adapter_list, location_string, interface_name);
     } while(0);
 
     return status;
 }
 
+/* Function add_not_found_adapter() adds to the adapter list an entry for a selector
+ * which could not be resolved, so in batch mode the output contains one entry per
+ * selector.
+ *
+ * Parameters:
+ * [in,out] adapter_list     Handle to adapter list
+ * [in]     selector         Handle to selector
+ * [in]     selector_status  Status of selector resolution
+ *
+ * Returns: DDP_SUCCESS or error code.
+ */
 ddp_status_t
-initialize_adapter(adapter_t* adapter)
+add_not_found_adapter(list_t* adapter_list, selector_t* selector, ddp_status_t selector_status)
 {
-    ddp_status_t status = DDP_SUCCESS;
+    adapter_t device;
 
-    switch(adapter->adapter_family)
+    MEMINIT(&device);
+
+    device.selector_status = selector_status;
+    device.branding_string = EMPTY_MESSAGE;
+    if(selector->type == adapter_location)
     {
-    case family_40G:
-        i40e_initialize_device(adapter);
-        break;
-    case family_100G: /* fall-through */
-    case family_100G_SW:
-    case family_100G_SWX:
-        ice_initialize_device(adapter);
-        break;
-    case family_none:
-    case family_last:
-        /* fall-through */
-    default:
-        adapter->tdi.discovery_device     = NULL;
-        adapter->tdi.is_virtual_function  = NULL;
-        status = DDP_INCORRECT_FUNCTION_PARAMETERS;
-        break;
+        sscanf(selector->key,
+               "%04hx:%02hx:%02hx.%hx",
+               &device.location.segment,
+               &device.location.bus,
+               &device.location.device,
+               &device.location.function);
+        strcpy_sec(device.connection_name,
+                   sizeof(device.connection_name),
+                   DDP_CONNECTION_NAME_NOT_AVAILABLE,
+                   strlen(DDP_CONNECTION_NAME_NOT_AVAILABLE));
+    }
+    else
+    {
+        strcpy_sec(device.connection_name,
+                   sizeof(device.connection_name),
+                   selector->key,
+                   strnlen(selector->key, sizeof(device.connection_name) - 1));
     }
+    strcpy_sec(device.profile_info.name,
+               DDP_PROFILE_NAME_LENGTH,
+               NOT_FOUND,
+               strlen(NOT_FOUND));
 
-    return status;
+    return add_adapter_to_list(adapter_list, &device);
 }
 
+/* Function generate_adapter_list_by_selectors() resolves every '-s'/'-i' selector
+ * directly in one process. In batch mode (more than one selector) selectors which
+ * cannot be resolved are reported as separate entries in the adapter list.
+ *
+ * Parameters:
+ * [in,out] adapter_list     Handle to adapter list
+ * [in]     selector_list    Handle to selector list
+ *
+ * Returns: DDP_SUCCESS if all selectors were resolved, error code otherwise.
+ */
 ddp_status_t
-generate_dummy_adapter_list(list_t* adapter_list)
+generate_adapter_list_by_selectors(list_t* adapter_list, list_t* selector_list)
 {
-    adapter_t*   dummy_adapter = NULL;
-    ddp_status_t status        = DDP_SUCCESS;
+    node_t*      node            = get_node(selector_list);
+    selector_t*  selector        = NULL;
+    ddp_status_t status          = DDP_SUCCESS;
+    ddp_status_t function_status = DDP_SUCCESS;
+    bool         is_batch        = (selector_list->number_of_nodes > 1) ? TRUE : FALSE;
 
-    do
+    /* single device - its net directory is read instead of a link dump of the whole host */
+    qdl_enable_pci_net_map(is_batch);
+
+    for(; node != NULL; node = get_next_node(node))
     {
-        dummy_adapter = malloc_sec(sizeof(adapter_t));
-        if(dummy_adapter == NULL)
+        selector = (selector_t*)node->data;
+
+        if(selector->type == adapter_location)
         {
-            break;
+            function_status = generate_adapter_by_location(adapter_list, selector->key, NULL);
+        }
+        else
+        {
+            function_status = generate_adapter_by_interface(adapter_list, selector->key);
         }
 
-        status = add_node_data(adapter_list, (void*) dummy_adapter, sizeof(adapter_t));
-        if(status != DDP_SUCCESS)
+        if(function_status == DDP_SUCCESS)
         {
-            break;
+            continue;
         }
-    } while (0);
+        debug_ddp_print("Selector %s status: 0x%X\n", selector->key, function_status);
+
+        if(status == DDP_SUCCESS)
+        {
+            status = function_status;
+        }
+        if(is_batch == TRUE)
+        {
+            function_status = add_not_found_adapter(adapter_list, selector, function_status);
+            if(function_status != DDP_SUCCESS)
+            {
+                status = function_status;
+                break;
+            }
+        }
+    }
 
     return status;
 }
 
 ddp_status_t
-generate_adapter_list(list_t* adapter_list, char* interface_key)
+generate_adapter_list(list_t* adapter_list, list_t* selector_list)
 {
     adapter_t       current_device;
     adapter_t       last_physical_device;
-    char            location_from_dir[PCI_LOCATION_STRING_SIZE +1];
-    adapter_t*      adapter             = NULL;
     struct dirent** name_list           = NULL;
     ddp_status_t    status              = DDP_SUCCESS;
     ddp_status_t    function_status     = DDP_SUCCESS;
     int32_t         items               = 0;
     int32_t         i                   = 0;
-    int             compare_result      = -1;
-    unsigned int    family              = family_none;
-    bool            is_vf               = FALSE;
+    uint32_t        skipped_devices     = 0;
+    bool            is_listed           = FALSE;
 
     MEMINIT(&current_device);
     MEMINIT(&last_physical_device);
-    MEMINIT(location_from_dir);
+
+    /* selected devices are resolved directly - without enumerating all PCI functions */
+    if(selector_list->number_of_nodes > 0)
+    {
+        return generate_adapter_list_by_selectors(adapter_list, selector_list);
+    }
 
     items = scandir(PATH_TO_SYSFS_PCI, &name_list, 0, alphasort);
     if(items < 0)
@@ -1232,169 +2101,63 @@ generate_adapter_list(list_t* adapter_list, char* interface_key)
         for(i = 0; i < items; MEMINIT(&current_device), i++)
         {
             /* Get adapter PCI location */
-            sscanf(name_list[i]->d_name,
-                "%04hx:%02hx:%02hx.%hx",
-                &current_device.location.segment,
-                &current_device.location.bus,
-                &current_device.location.device,
-                &current_device.location.function);
-
-            function_status = get_device_identifier(&current_device);
-            if(function_status != DDP_SUCCESS && status == DDP_SUCCESS)
+            if(sscanf(name_list[i]->d_name,
+                      "%04hx:%02hx:%02hx.%hx",
+                      &current_device.location.segment,
+                      &current_device.location.bus,
+                      &current_device.location.device,
+                      &current_device.location.function) != 4)
             {
-                debug_ddp_print("get_device_identifier error: 0x%X\n", function_status);
-                status = function_status;
-                continue;
+                continue; /* '.' and '..' entries */
             }
 
-            if(is_device_supported(&current_device) == FALSE)
+            /* drop non-Intel and non-network functions before deep probing */
+            if(is_intel_network_function(&current_device.location) == FALSE)
             {
+                skipped_devices++;
                 continue;
             }
-            debug_ddp_print("Device location: %s\n", name_list[i]->d_name);
 
-            /* if the device is supported - verify if the associated driver is available/supported */
-            for(family = family_none; family < family_last; family++)
-            {
-                if(current_device.adapter_family == family)
-                {
-                    if(Global_driver_os_ctx[family].driver_available == FALSE)
-                    {
-                        function_status = DDP_NO_BASE_DRIVER;
-                        debug_ddp_print("No base driver.\n");
-                        break;
-                    }
-                    if(Global_driver_os_ctx[family].driver_supported == FALSE)
-                    {
-                        function_status = DDP_UNSUPPORTED_BASE_DRIVER;
-                        debug_ddp_print("Base driver not supported.\n");
-                        break;
-                    }
-                }
-            }
+            function_status = probe_device(&current_device, &last_physical_device, &is_listed);
             if(function_status != DDP_SUCCESS && status == DDP_SUCCESS)
             {
                 status = function_status;
-                continue;
-            }
-
-            /* Initialize created node */
-            function_status = initialize_adapter(&current_device);
-            if(function_status != DDP_SUCCESS && status == DDP_SUCCESS)
-            {
-                status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-                continue;
             }
-
-            is_vf = is_virtual_function(&current_device);
-            if(is_vf == TRUE)
+            if(is_listed == FALSE)
             {
-                if(check_command_parameter(DDP_ALL_ADAPTERS_PARAMETER_BIT) == FALSE)
-                {
-                    /* only with parameter -a tool works with virtual functions*/
-                    continue;
-                }
-
-                current_device.is_virtual_function = TRUE;
-                current_device.is_usable = FALSE; /* virtual function cannot be use for communicate with base driver */
-
-                if(last_physical_device.is_usable == TRUE)
+                if(current_device.branding_string_allocated == TRUE)
                 {
-                    strcpy_sec(current_device.pf_connection_name,
-                                sizeof(current_device.pf_connection_name),
-                                last_physical_device.connection_name,
-                                strlen(last_physical_device.connection_name)); /* need for getting data by base driver */
-                    memcpy_sec(&current_device.pf_location,
-                                sizeof(current_device.pf_location),
-                                &last_physical_device.location,
-                                sizeof(last_physical_device.location));
-                    current_device.pf_device_id = last_physical_device.device_id;
-                    current_device.is_usable = TRUE; /* it's true if we have a connection name from physical function */
+                    free_memory(current_device.branding_string);
                 }
+                continue;
             }
 
-            function_status = get_connection_name(&current_device);
-            if(function_status == DDP_SUCCESS)
-            {
-                current_device.is_usable = TRUE;
-            }
-            else
-            {
-                /* if the driver did not write connection name to sysfs
-                * we cannot use ioctl to communicate with that function */
-                current_device.is_usable = FALSE;
-                debug_ddp_print("get_connection_name error: 0x%X\n", function_status);
-                /* the adapter must be added to the adapter list, so the tool cannot skip this iteration of the loop */
-            }
-
-            if(is_vf == FALSE && current_device.is_usable == TRUE)
+            if(current_device.is_virtual_function == FALSE && current_device.is_usable == TRUE)
             {
                 memcpy_sec(&last_physical_device, sizeof(adapter_t), &current_device, sizeof(adapter_t));
             }
 
-            if(check_command_parameter(DDP_LOCATION_COMMAND_PARAMETER_BIT))
-            {
-                memcpy_sec(location_from_dir,
-                            PCI_LOCATION_STRING_SIZE,
-                            name_list[i]->d_name,
-                            PCI_LOCATION_STRING_SIZE);
-                compare_result = strncmp(interface_key, location_from_dir, PCI_LOCATION_STRING_SIZE);
-                if(compare_result != 0)
-                {
-                    continue;
-                }
-            }
-            else if(check_command_parameter(DDP_INTERFACE_COMMAND_PARAMETER_BIT) &&
-                    strlen(current_device.connection_name))
+            function_status = add_adapter_to_list(adapter_list, &current_device);
+            if(function_status != DDP_SUCCESS)
             {
-                /* we need PF for VF */
-                compare_result = strcmp(interface_key, current_device.connection_name);
-                if(compare_result != 0)
+                if(current_device.branding_string_allocated == TRUE)
                 {
-                    continue;
+                    free_memory(current_device.branding_string);
                 }
-            }
-
-            adapter = malloc_sec(sizeof(adapter_t));
-            if(adapter == NULL)
-            {
-                status = DDP_ALLOCATE_MEMORY_FAIL;
-                break;
-            }
-            memcpy_sec(adapter, sizeof(adapter_t), &current_device, sizeof(current_device));
-
-            /* Add node to the list */
-            debug_ddp_print("Adding to list device: 0x%X:0x%X:0x%X.0x%X\n",
-                            adapter->location.segment,
-                            adapter->location.bus,
-                            adapter->location.device,
-                            adapter->location.function);
-            function_status = add_node_data(adapter_list, (void*)adapter, sizeof(adapter_t));
-            if(function_status != DDP_SUCCESS)
-            {
                 if(status == DDP_SUCCESS)
                 {
                     status = function_status;
                 }
-                continue;
-            }
-
-            if(compare_result == 0)
-            {
-                debug_ddp_print("Resetting status due to success in found adapter: 0x%X\n", status);
-                status = DDP_SUCCESS;
-                break; /* the provided device was found - skipping enumarete next devices */
+                if(function_status == DDP_ALLOCATE_MEMORY_FAIL)
+                {
+                    break;
+                }
             }
         }
 
-        if(status == DDP_SUCCESS                                        &&
-        adapter_list->number_of_nodes == 0                              &&
-        (check_command_parameter(DDP_INTERFACE_COMMAND_PARAMETER_BIT) ||
-         check_command_parameter(DDP_LOCATION_COMMAND_PARAMETER_BIT)))
-        {
-            status = DDP_DEVICE_NOT_FOUND;
-        }
-        else if(status == DDP_SUCCESS && adapter_list->first_node == NULL)
+        debug_ddp_print("Prefilter skipped %d non-Intel or non-network PCI functions\n", skipped_devices);
+
+        if(status == DDP_SUCCESS && adapter_list->first_node == NULL)
         {
             status = DDP_NO_SUPPORTED_ADAPTER;
         }
@@ -1409,6 +2172,99 @@ generate_adapter_list(list_t* adapter_list, char* interface_key)
     return status;
 }
 
+/* Function dump_region() dumps DevLink region selected by '--dump-region' of the only
+ * adapter on the list and reports the throughput.
+ *
+ * Parameters:
+ * [in] adapter_list  Handle to adapter list
+ * [in] file_name     Output file name, standard output is used if NULL
+ *
+ * Returns: DDP_SUCCESS or error code.
+ */
+ddp_status_t
+dump_region(list_t* adapter_list, char* file_name)
+{
+    ice_region_dump_t dump;
+    node_t*           node          = get_node(adapter_list);
+    adapter_t*        adapter       = NULL;
+    FILE*             report_stream = stdout;
+    double            throughput    = 0;
+    ddp_status_t      status        = DDP_SUCCESS;
+
+    MEMINIT(&dump);
+
+    do
+    {
+        if(node == NULL)
+        {
+            status = DDP_NO_SUPPORTED_ADAPTER;
+            break;
+        }
+
+        adapter = get_adapter_from_list_node(node);
+        if(adapter->selector_status != DDP_SUCCESS)
+        {
+            status = adapter->selector_status;
+            break;
+        }
+
+        /* Regions are exposed only by the ice base driver */
+        if(adapter->adapter_family != family_100G    &&
+           adapter->adapter_family != family_100G_SW &&
+           adapter->adapter_family != family_100G_SWX)
+        {
+            debug_ddp_print("Region dump is not supported for this device\n");
+            status = DDP_NO_SUPPORTED_ADAPTER;
+            break;
+        }
+
+        status = determine_output_stream(&dump.stream, file_name);
+        if(status != DDP_SUCCESS)
+        {
+            break;
+        }
+
+        status = ice_dump_region(adapter, get_dump_region(), &dump);
+        if(status != DDP_SUCCESS)
+        {
+            debug_ddp_print("ice_dump_region error: 0x%X\n", status);
+            break;
+        }
+
+        if(check_command_parameter(DDP_SILENT_MODE_PARAMETER_BIT) == TRUE)
+        {
+            break;
+        }
+
+        /* Report shall not be mixed with the dump sent to standard output */
+        if(dump.stream == stdout)
+        {
+            report_stream = stderr;
+        }
+        if(dump.elapsed_time != 0)
+        {
+            throughput = (double)dump.bytes_written / (double)dump.elapsed_time; /* bytes per us = MB/s */
+        }
+        fprintf(report_stream,
+                "Region %s: %llu bytes read in %u windows in %.3f s (%.2f MB/s)\n",
+                get_dump_region(),
+                (unsigned long long)dump.bytes_written,
+                dump.number_of_windows,
+                (double)dump.elapsed_time / 1000000,
+                throughput);
+    } while(0);
+
+    if(dump.stream != NULL && dump.stream != stdout)
+    {
+        if(fclose(dump.stream) != 0 && status == DDP_SUCCESS)
+        {
+            status = DDP_CANNOT_CREATE_OUTPUT_FILE;
+        }
+    }
+
+    return status;
+}
+
 void
 free_ddp_adapter_list_allocated_fields(list_t* adapter_list)
 {
@@ -1424,6 +2280,7 @@ free_ddp_adapter_list_allocated_fields(list_t* adapter_list)
         {
             free_memory(ddp_adapter->branding_string);
         }
+        close_ioctl_transport(ddp_adapter);
         node = next_node;
     }
 }
@@ -1432,18 +2289,19 @@ int
 main(int argc, char** argv)
 {
     list_t       adapter_list;
+    list_t       selector_list;
     char*        file_name       = NULL;
     char*        input_file_name = NULL;
-    char*        interface_key   = NULL;
     ddp_status_t function_status = DDP_SUCCESS;
     ddp_status_t status          = DDP_SUCCESS;
 
     MEMINIT(&adapter_list);
+    MEMINIT(&selector_list);
     memset(&Global_driver_os_ctx, 0, sizeof(driver_os_context_t) * family_last);
 
     do
     {
-        function_status = parse_command_line_parameters(argc, argv, &interface_key, &file_name, &input_file_name);
+        function_status = parse_command_line_parameters(argc, argv, &selector_list, &file_name, &input_file_name);
 
         print_header();
 
@@ -1486,7 +2344,7 @@ main(int argc, char** argv)
             break; /* In binary file analyzing mode the tool shouldn't work with the physical adapters. */
         }
 
-        function_status = generate_adapter_list(&adapter_list, interface_key);
+        function_status = generate_adapter_list(&adapter_list, &selector_list);
         if(function_status != DDP_SUCCESS)
         {
             /* Do not break in case of errors - we still want to perform
@@ -1500,6 +2358,17 @@ main(int argc, char** argv)
             break;
         }
 
+        if(check_command_parameter(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT) == TRUE)
+        {
+            function_status = dump_region(&adapter_list, file_name);
+            if(function_status != DDP_SUCCESS)
+            {
+                status = function_status;
+            }
+
+            break; /* In region dump mode the tool doesn't discover profiles */
+        }
+
         function_status = discovery_devices(adapter_list);
         if(function_status != DDP_SUCCESS && status == DDP_SUCCESS)
         {
@@ -1516,14 +2385,25 @@ main(int argc, char** argv)
 
     status = validate_output_status(status);
 
-    function_status = ddp_func_print_adapter_list(&adapter_list, status, file_name);
-    if(function_status != DDP_SUCCESS)
+    /* Region dump has its own output */
+    if(check_command_parameter(DDP_DUMP_REGION_COMMAND_PARAMETER_BIT) == FALSE)
     {
-        status = function_status;
+        function_status = ddp_func_print_adapter_list(&adapter_list, status, file_name);
+        if(function_status != DDP_SUCCESS)
+        {
+            status = function_status;
+        }
     }
 
     free_ddp_adapter_list_allocated_fields(&adapter_list);
     free_list(&adapter_list);
+    free_list(&selector_list);
+    free_supported_devices_index();
+    release_pci_ids_index();
+    ice_release_devlink_info_map();
+    qdl_close_session();
+    qdl_release_pci_cache();
+    release_arena();
 
     return status;
 }
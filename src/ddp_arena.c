@@ -0,0 +1,144 @@
+/*************************************************************************************************************
+* Copyright (C) 2019 Intel Corporation                                                                       *
+*                                                                                                            *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided    *
+* that the following conditions are met:                                                                     *
+*                                                                                                            *
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the  *
+*    following disclaimer.                                                                                   *
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and   *
+*      the following disclaimer in the documentation and/or other materials provided with the distribution.  *
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or    *
+*    promote products derived from this software without specific prior written permission.                  *
+*                                                                                                            *
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED     *
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A     *
+* PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR   *
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED *
+* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)  *
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING   *
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE        *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                *
+*                                                                                                            *
+* SPDX-License-Identifier: BSD-3-Clause                                                                      *
+*************************************************************************************************************/
+
+#include <inttypes.h>
+#include "ddp.h"
+#include "ddp_arena.h"
+
+/* Per-run arena - objects which live until the end of the run are carved from big blocks
+ * and released all at once by release_arena(). Arena memory must never be passed to
+ * free_memory(). Objects which may be released earlier shall use malloc_sec() and
+ * free_memory() instead.
+ */
+static ddp_arena_t Global_arena = {NULL, PTHREAD_MUTEX_INITIALIZER, {0, 0, 0, 0}};
+
+/* Function arena_malloc() allocates zeroed memory from the per-run arena.
+ *
+ * Parameters:
+ * [in] size     Number of bytes to allocate
+ *
+ * Returns: Handle to allocated memory or NULL.
+ */
+void*
+arena_malloc(size_t size)
+{
+    ddp_arena_block_t* block        = NULL;
+    void*              buffer       = NULL;
+    size_t             aligned_size = (size + DDP_ARENA_ALIGNMENT - 1) & ~((size_t)DDP_ARENA_ALIGNMENT - 1);
+    size_t             block_size   = DDP_ARENA_BLOCK_SIZE;
+
+    if(size == 0)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&Global_arena.lock);
+
+    do
+    {
+        block = Global_arena.first_block;
+        if(block == NULL || block->size - block->used < aligned_size)
+        {
+            /* big allocations get a block of their own */
+            if(aligned_size > block_size)
+            {
+                block_size = aligned_size;
+            }
+
+            block = malloc(sizeof(ddp_arena_block_t) + block_size);
+            if(block == NULL)
+            {
+                debug_ddp_print("Cannot allocate arena block of %zu bytes\n", block_size);
+                break;
+            }
+            block->size = block_size;
+            block->used = 0;
+
+            /* the current block keeps its free space if the new block is used up at once */
+            if(Global_arena.first_block != NULL && aligned_size == block_size)
+            {
+                block->next = Global_arena.first_block->next;
+                Global_arena.first_block->next = block;
+            }
+            else
+            {
+                block->next = Global_arena.first_block;
+                Global_arena.first_block = block;
+            }
+
+            Global_arena.statistics.number_of_blocks++;
+            Global_arena.statistics.reserved_bytes += block_size;
+        }
+
+        buffer = block->data + block->used;
+        block->used += aligned_size;
+
+        Global_arena.statistics.number_of_allocations++;
+        Global_arena.statistics.allocated_bytes += size;
+    } while(0);
+
+    pthread_mutex_unlock(&Global_arena.lock);
+
+    if(buffer != NULL)
+    {
+        memset(buffer, 0, size);
+    }
+
+    return buffer;
+}
+
+void
+get_arena_statistics(ddp_arena_statistics_t* statistics)
+{
+    pthread_mutex_lock(&Global_arena.lock);
+    *statistics = Global_arena.statistics;
+    pthread_mutex_unlock(&Global_arena.lock);
+}
+
+/* Function release_arena() releases all memory allocated from the per-run arena */
+void
+release_arena(void)
+{
+    ddp_arena_block_t* block      = NULL;
+    ddp_arena_block_t* next_block = NULL;
+
+    pthread_mutex_lock(&Global_arena.lock);
+
+    debug_ddp_print("Arena: %" PRIu64 " allocations (%" PRIu64 " bytes) served from %" PRIu64 " blocks (%" PRIu64 " bytes)\n",
+                    Global_arena.statistics.number_of_allocations,
+                    Global_arena.statistics.allocated_bytes,
+                    Global_arena.statistics.number_of_blocks,
+                    Global_arena.statistics.reserved_bytes);
+
+    for(block = Global_arena.first_block; block != NULL; block = next_block)
+    {
+        next_block = block->next;
+        free(block);
+    }
+    Global_arena.first_block = NULL;
+    MEMINIT(&Global_arena.statistics);
+
+    pthread_mutex_unlock(&Global_arena.lock);
+}
@@ -37,18 +37,15 @@ get_next_node(node_t* node)
     return NULL;
 }
 
+/* List nodes and their data are allocated from the per-run arena and released by
+ * release_arena(), the list is only emptied here.
+ */
 void
 free_list(list_t* list)
 {
-    node_t* node      = get_node(list);
-    node_t* next_node = NULL;
-
-    while(node != NULL)
+    if(list != NULL)
     {
-        next_node = node->next_node;
-        free_memory(node->data);
-        free_memory(node);
-        node = next_node;
+        MEMINIT(list);
     }
 }
 
@@ -93,7 +90,7 @@ add_node_data(list_t* list, void* node, size_t size)
             break;
         }
 
-        new_node = malloc_sec(sizeof(node_t));
+        new_node = arena_malloc(sizeof(node_t));
         if(new_node == NULL)
         {
             status = DDP_ALLOCATE_MEMORY_FAIL;
@@ -162,9 +159,7 @@ remove_current_node(list_t* list, void* node)
             list->first_node = current_node->next_node;
         }
 
-        /* Remove node from the list */
-        free_memory(current_node->data);
-        free_memory(current_node);
+        /* Remove node from the list - its memory is released with the arena */
         list->number_of_nodes--;
     } while(0);
 
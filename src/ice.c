@@ -33,6 +33,17 @@
 #define DDPT_IS_TYPE_ALIGNED(type, length)  ((sizeof(type) % (length)) == 0 ? true : false)
 #define DDPT_TYPE_LENGTH(type, length)      (sizeof(type) / (length))
 
+/* The devlink module opens one netlink session per thread, so devlink requests of parallel
+ * discovery threads do not need to be serialized - the lock only guards loading of the map below.
+ */
+static pthread_mutex_t ice_devlink_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* BDF -> profile information map built from one DevLink INFO_GET dump, loaded under ice_devlink_lock
+ * and read only afterwards */
+static ice_devlink_info_map_t ice_devlink_info_map        = {NULL, 0, 0};
+static bool                   ice_devlink_info_map_loaded = FALSE;
+static bool                   ice_devlink_info_map_valid  = FALSE;  /* dump succeeded - map lists all DevLink devices */
+
 supported_devices_t ice_supported_devices[] =
 {
         /*=============================================*/
@@ -280,7 +291,6 @@ _ice_send_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor)
 {
     uint32_t*    desc   = (uint32_t*)descriptor;
     ddp_status_t status = DDP_SUCCESS;
-    uint32_t     i      = 0;
     uint32_t     hicr   = 0;
 
     do
@@ -292,18 +302,11 @@ _ice_send_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor)
             break;
         }
 
-        for(i = 0; i < sizeof(adminq_desc_t) / DDP_DWORD_LENGTH; i++)
-        {
-            status = write_register(adapter, GL_HIDA(i), DDP_DWORD_LENGTH, &desc[i]);
-            if(status != DDP_SUCCESS)
-            {
-                debug_ddp_print("%d: send adminQ failed during writing register [iteration %d]\n", __LINE__, i);
-                debug_ddp_print("write register failed: 0x%X\n", status);
-                break;
-            }
-        }
+        status = write_registers(adapter, GL_HIDA(0), sizeof(adminq_desc_t) / DDP_DWORD_LENGTH, desc);
         if(status != DDP_SUCCESS)
         {
+            debug_ddp_print("%d: send adminQ failed during writing descriptor registers\n", __LINE__);
+            debug_ddp_print("write register failed: 0x%X\n", status);
             break;
         }
 
@@ -332,7 +335,6 @@ _ice_recv_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor)
     adminq_desc_t received_descriptor;
     uint32_t*     desc        = (uint32_t*)&received_descriptor;
     ddp_status_t  status      = DDP_SUCCESS;
-    uint32_t      i           = 0;
     uint32_t      desc_length = DDPT_TYPE_LENGTH(adminq_desc_t, DDP_DWORD_LENGTH);
 
     /* Check asserts */
@@ -349,15 +351,11 @@ _ice_recv_adminq_command(adapter_t* adapter, adminq_desc_t* descriptor)
             break;
         }
 
-        for(i = 0; i < desc_length; i++)
+        status = read_registers(adapter, GL_HIDA(0), desc_length, desc);
+        if(status != DDP_SUCCESS)
         {
-            status = read_register(adapter, GL_HIDA(i), DDP_DWORD_LENGTH, &desc[i]);
-            if(status != DDP_SUCCESS)
-            {
-                debug_ddp_print("%d: send adminQ failed during read register 0x%X\n", __LINE__, GL_HIDA(i));
-                debug_ddp_print("read register failed: 0x%X\n", status);
-                break;
-            }
+            debug_ddp_print("%d: send adminQ failed during reading descriptor registers\n", __LINE__);
+            debug_ddp_print("read register failed: 0x%X\n", status);
         }
 
         /* validate response */
@@ -382,226 +380,633 @@ ddp_status_t
 _ice_recv_adminq_buffer(adapter_t* adapter, uint8_t* buffer, uint32_t buffer_size)
 {
     ddp_status_t status = DDP_SUCCESS;
-    uint32_t     i      = 0;
 
-    for(i = 0; i < buffer_size / DDP_DWORD_LENGTH ; i++)
+    if(buffer_size >= DDP_DWORD_LENGTH)
     {
-        status = read_register(adapter, GL_HIBA(i), DDP_DWORD_LENGTH, &buffer[i * DDP_DWORD_LENGTH]);
+        status = read_registers(adapter, GL_HIBA(0), buffer_size / DDP_DWORD_LENGTH, buffer);
         if(status != DDP_SUCCESS)
         {
-            debug_ddp_print("%d: send adminQ failed during read register 0x%X\n", __LINE__, GL_HIBA(i));
+            debug_ddp_print("%d: send adminQ failed during reading buffer registers\n", __LINE__);
             debug_ddp_print("read register failed: 0x%X\n", status);
-            break;
         }
     }
 
     return status;
 }
 
+/* Function returns monotonic time in microseconds */
+uint64_t
+_ice_get_time_us(void)
+{
+    struct timespec now;
+
+    MEMINIT(&now);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+/* Function opens CSR adminq session - the adminq is acquired once and may be used by
+ * several commands until the session is closed.
+ *
+ * Parameters:
+ * [in]  adapter      Handle to adapter
+ * [out] session      Handle to session
+ *
+ * Returns: DDP status.
+ */
 ddp_status_t
-_ice_get_data_by_csr(adapter_t* adapter, adminq_desc_t* descriptor, uint8_t* buffer, uint16_t buffer_size)
+_ice_open_csr_session(adapter_t* adapter, ice_csr_session_t* session)
 {
-    ddp_status_t status             = DDP_SUCCESS;
-    uint32_t     hicr               = 0;
-    uint32_t     i                  = 0;
-    bool         is_adminq_acquired = FALSE;
+    ddp_status_t status = DDP_SUCCESS;
 
-    do
+    MEMINIT(session);
+    session->adapter = adapter;
+
+    /* aquire AdminQ - if it fails the lock belongs to someone else and must not be released */
+    status = _ice_acquire_adminq(adapter);
+    if(status != DDP_SUCCESS)
+    {
+        debug_ddp_print("_ice_acquire_adminq 0x%X\n", status);
+    }
+    else
+    {
+        session->is_acquired = TRUE;
+    }
+
+    return status;
+}
+
+/* Function closes CSR adminq session and releases the adminq.
+ *
+ * Parameters:
+ * [in,out] session      Handle to session
+ *
+ * Returns: DDP status of adminq release.
+ */
+ddp_status_t
+_ice_close_csr_session(ice_csr_session_t* session)
+{
+    ddp_status_t status = DDP_SUCCESS;
+
+    if(session->is_acquired == TRUE)
     {
-        /* aquire AdminQ */
-        status = _ice_acquire_adminq(adapter);
+        /* release AdminQ */
+        status = _ice_release_adminq(session->adapter);
         if(status != DDP_SUCCESS)
         {
-            debug_ddp_print("_ice_acquire_adminq 0x%X\n", status);
-            _ice_release_adminq(adapter);
+            debug_ddp_print("_ice_release_adminq error 0x%X\n", status);
+        }
+        debug_ddp_print("CSR adminQ session closed after %d command(s)\n", session->number_of_commands);
+        session->is_acquired = FALSE;
+    }
+
+    return status;
+}
+
+/* Function prepares descriptor of adminq command sent by the discovery.
+ *
+ * Parameters:
+ * [out] descriptor   Admin Queue descriptor
+ * [in]  command      ICE_ADMINQ_COMMAND_GET_VERSION or ICE_ADMINQ_COMMAND_GET_DDP_PROFILE_LIST
+ *
+ * Returns: None
+ */
+void
+_ice_prepare_adminq_command(adminq_desc_t* descriptor, uint16_t command)
+{
+    descriptor->opcode = command;
+    if(command == ICE_ADMINQ_COMMAND_GET_DDP_PROFILE_LIST)
+    {
+        descriptor->flags   = ICE_AQ_FLAG_BUF | ICE_AQ_FLAG_SI;
+        descriptor->datalen = sizeof(ice_profiles_info_t);
+    }
+    else
+    {
+        descriptor->flags   = ICE_AQ_FLAG_SI;
+        descriptor->datalen = 0;
+    }
+}
+
+/* Function checks if FW version returned by GET_VERSION command is supported.
+ *
+ * Parameters:
+ * [in] descriptor   Admin Queue descriptor with GET_VERSION response
+ *
+ * Returns: TRUE if FW is supported, FALSE otherwise.
+ */
+bool
+_ice_is_fw_version_supported(adminq_desc_t* descriptor)
+{
+    ice_aqc_get_ver_t* get_version     = (ice_aqc_get_ver_t*)descriptor->params.raw;
+    bool               is_fw_supported = FALSE;
+
+    debug_ddp_print("fw version: 0x%X 0x%X 0x%X 0x%X 0x%X\n",
+                    get_version->fw_branch,
+                    get_version->fw_major,
+                    get_version->fw_minor,
+                    get_version->fw_patch,
+                    get_version->fw_build);
+
+    if(get_version->fw_major > ICE_MIN_FW_VERSION_MAJOR)
+    {
+        is_fw_supported = TRUE;
+    }
+    else if(get_version->fw_major == ICE_MIN_FW_VERSION_MAJOR  &&
+            get_version->fw_minor >  ICE_MIN_FW_VERSION_MINOR)
+    {
+        is_fw_supported = TRUE;
+    }
+    else if(get_version->fw_major == ICE_MIN_FW_VERSION_MAJOR  &&
+            get_version->fw_minor == ICE_MIN_FW_VERSION_MINOR  &&
+            get_version->fw_patch >= ICE_MIN_FW_VERSION_PATCH)
+    {
+        is_fw_supported = TRUE;
+    }
+
+    return is_fw_supported;
+}
+
+/* Function copies active profile from GET_DDP_PROFILE_LIST response to the adapter.
+ *
+ * Parameters:
+ * [in,out] adapter        Handle to adapter
+ * [in]     profiles_info  GET_DDP_PROFILE_LIST response buffer
+ *
+ * Returns: DDP_SUCCESS or DDP_NO_DDP_PROFILE.
+ */
+ddp_status_t
+_ice_set_adminq_ddp_profile_list(adapter_t* adapter, ice_profiles_info_t* profiles_info)
+{
+    ddp_status_t status         = DDP_SUCCESS;
+    uint8_t      profile_number = 0;
+
+    do
+    {
+        /* Copy data from ICE strcute to the generic tool structure */
+        if(profiles_info->count == 0)
+        {
+            status = DDP_NO_DDP_PROFILE;
             break;
         }
 
-        is_adminq_acquired = TRUE;
+        debug_ddp_print("Found %d profile(s)\n", profiles_info->count);
 
-        /* send request to the FW */
-        status = _ice_send_adminq_command(adapter, descriptor);
-        if(status != DDP_SUCCESS)
+        adapter->profile_info.section_size = profiles_info->count;
+        for(profile_number = 0; profile_number < ICE_PROFILES_NUMBER; profile_number++)
         {
-            debug_ddp_print("_ice_send_adminq_command error 0x%X\n", status);
+            debug_ddp_print("Profile: %d:\n", profile_number);
+            debug_ddp_print("  IsActive: %d\n", profiles_info->profile[profile_number].is_active);
+            debug_ddp_print("  Name:     %s\n", profiles_info->profile[profile_number].name);
+            debug_ddp_print("  TrackId:  %x\n", profiles_info->profile[profile_number].track_id);
+            /* The tool shall reports only active profile */
+            if(profiles_info->profile[profile_number].is_active == TRUE)
+            {
+                adapter->profile_info.version      = profiles_info->profile[profile_number].version;
+                adapter->profile_info.track_id     = profiles_info->profile[profile_number].track_id;
+                memcpy_sec(adapter->profile_info.name,
+                           DDP_PROFILE_NAME_LENGTH,
+                           profiles_info->profile[profile_number].name,
+                           ICE_PROFILE_NAME_LENGTH);
+                break;
+            }
+        }
+    } while (0);
+
+    return status;
+}
+
+/* Function moves CSR machine to the release step with final status of the discovery */
+void
+_ice_finish_csr_machine(ice_csr_machine_t* machine, ddp_status_t status)
+{
+    machine->status = status;
+    machine->state  = ice_csr_state_release;
+}
+
+/* Function moves CSR machine to the send step of given adminq command */
+void
+_ice_start_csr_command(ice_csr_machine_t* machine, uint16_t command)
+{
+    _ice_prepare_adminq_command(machine->descriptor, command);
+    machine->state = ice_csr_state_send;
+}
+
+/* Function executes a single non-blocking step of the CSR discovery of an adapter:
+ * acquire -> (send -> poll -> receive) for GET_VERSION and GET_DDP_PROFILE_LIST -> release.
+ * Poll step reads HICR once - if FW has not completed the command yet, the next read is
+ * scheduled with the same spin and backoff schedule for every adapter.
+ *
+ * Parameters:
+ * [in,out] machine      Handle to CSR machine
+ * [in]     now          Current monotonic time in microseconds
+ *
+ * Returns: TRUE if the step was executed, FALSE if machine waits for the next poll.
+ */
+bool
+_ice_step_csr_machine(ice_csr_machine_t* machine, uint64_t now)
+{
+    adapter_t*   adapter = machine->session.adapter;
+    ddp_status_t status  = DDP_SUCCESS;
+    uint32_t     hicr    = 0;
+
+    switch(machine->state)
+    {
+        case ice_csr_state_acquire:
+        {
+            /* adminQ lock is global for the device - its machines run one at a time */
+            if(machine->previous != NULL && machine->previous->state != ice_csr_state_done)
+            {
+                return FALSE;
+            }
+            debug_ddp_print("Trying to read profile by AdminQ inteface.\n");
+            status = _ice_open_csr_session(adapter, &machine->session);
+            if(status != DDP_SUCCESS)
+            {
+                debug_ddp_print("Cannot acquire adminQ for currently printed adapter\n");
+                _ice_finish_csr_machine(machine, status);
+                break;
+            }
+            _ice_start_csr_command(machine, ICE_ADMINQ_COMMAND_GET_VERSION);
             break;
         }
+        case ice_csr_state_send:
+        {
+            machine->session.number_of_commands++;
+            machine->number_of_ioctls = adapter->transport.number_of_ioctls;
+
+            /* cookie low dword is the lock timestamp - refresh it */
+            machine->descriptor->cookie_low = (uint32_t)time(NULL);
 
-        /* timeout */
-        for(i = 0; i < 100000; i++)
+            /* send request to the FW */
+            status = _ice_send_adminq_command(adapter, machine->descriptor);
+            if(status != DDP_SUCCESS)
+            {
+                debug_ddp_print("_ice_send_adminq_command error 0x%X\n", status);
+                _ice_finish_csr_machine(machine, status);
+                break;
+            }
+            machine->poll_start = now;
+            machine->next_poll  = now;
+            machine->backoff    = ICE_CSR_POLL_MIN_BACKOFF_US;
+            machine->polls      = 0;
+            machine->state      = ice_csr_state_poll;
+            break;
+        }
+        case ice_csr_state_poll:
         {
+            if(now < machine->next_poll)
+            {
+                return FALSE;
+            }
+
+            /* wait for the FW response */
             status = read_register(adapter, ICE_GL_HICR_REGISTER, DDP_DWORD_LENGTH, &hicr);
+            machine->polls++;
             if(status != DDP_SUCCESS)
             {
+                _ice_finish_csr_machine(machine, status);
                 break;
             }
             if((hicr & ICE_GL_HICR_STATUS_VALID_BIT) != 0 ||
                (hicr & ICE_GL_HICR_COMMAND_BIT)      == 0)
             {
+                debug_ddp_print("CSR adminQ command 0x%X completion latency: %lu us, HICR polled %d times\n",
+                                machine->descriptor->opcode,
+                                now - machine->poll_start,
+                                machine->polls);
+                machine->state = ice_csr_state_receive;
+                break;
+            }
+            if(now - machine->poll_start >= ICE_CSR_POLL_DEADLINE_US)
+            {
+                debug_ddp_print("AdminQ command 0x%X not completed in %d us\n",
+                                machine->descriptor->opcode,
+                                ICE_CSR_POLL_DEADLINE_US);
+                _ice_finish_csr_machine(machine, DDP_AQ_COMMAND_FAIL);
                 break;
             }
-            usleep(1);
-        }
 
-        /* received data form host interface descriptor area (hida) */
-        status = _ice_recv_adminq_command(adapter, descriptor);
-        if(status != DDP_SUCCESS)
-        {
-            debug_ddp_print("_ice_recv_adminq_command error 0x%X\n", status);
+            /* read HICR back to back for the first polls, then back off exponentially */
+            if(machine->polls > ICE_CSR_POLL_SPIN_COUNT)
+            {
+                machine->next_poll = now + machine->backoff;
+                machine->backoff   = machine->backoff * 2 > ICE_CSR_POLL_MAX_BACKOFF_US ?
+                                     ICE_CSR_POLL_MAX_BACKOFF_US : machine->backoff * 2;
+            }
             break;
         }
-
-        /* the respons is expected as a part of descriptor */
-        if(buffer == NULL)
+        case ice_csr_state_receive:
         {
+            /* received data form host interface descriptor area (hida) */
+            status = _ice_recv_adminq_command(adapter, machine->descriptor);
+            if(status == DDP_SUCCESS && machine->descriptor->opcode == ICE_ADMINQ_COMMAND_GET_DDP_PROFILE_LIST)
+            {
+                /* received data form host interface buffer area (hiba) */
+                status = _ice_recv_adminq_buffer(adapter, (uint8_t*)&machine->profiles_info, sizeof(machine->profiles_info));
+            }
+            debug_ddp_print("CSR adminQ command 0x%X: %d ioctl calls\n",
+                            machine->descriptor->opcode,
+                            adapter->transport.number_of_ioctls - machine->number_of_ioctls);
+            if(status != DDP_SUCCESS)
+            {
+                debug_ddp_print("CSR adminQ command 0x%X error 0x%X\n", machine->descriptor->opcode, status);
+                _ice_finish_csr_machine(machine, status);
+                break;
+            }
+
+            if(machine->descriptor->opcode == ICE_ADMINQ_COMMAND_GET_VERSION)
+            {
+                if(_ice_is_fw_version_supported(machine->descriptor) == FALSE)
+                {
+                    strcpy_sec(adapter->profile_info.name,
+                               DDP_PROFILE_NAME_LENGTH,
+                               UNSUPPORTED_FW,
+                               strlen(UNSUPPORTED_FW));
+                    _ice_finish_csr_machine(machine, DDP_NO_SUPPORTED_ADAPTER);
+                    break;
+                }
+                _ice_start_csr_command(machine, ICE_ADMINQ_COMMAND_GET_DDP_PROFILE_LIST);
+                break;
+            }
+
+            status = _ice_set_adminq_ddp_profile_list(adapter, &machine->profiles_info);
+            if(status == DDP_NO_DDP_PROFILE)
+            {
+                strcpy_sec(adapter->profile_info.name,
+                           DDP_PROFILE_NAME_LENGTH,
+                           NO_PROFILE,
+                           strlen(NO_PROFILE));
+            }
+            _ice_finish_csr_machine(machine, status);
             break;
         }
-
-        /* received data form host interface buffer area (hiba) */
-        status = _ice_recv_adminq_buffer(adapter, buffer, buffer_size);
-        if(status != DDP_SUCCESS)
+        case ice_csr_state_release:
         {
-            debug_ddp_print("_ice_recv_adminq_buffer error 0x%X\n", status);
+            _ice_close_csr_session(&machine->session);
+            machine->state = ice_csr_state_done;
             break;
         }
-    } while (0);
-
-    if(is_adminq_acquired == TRUE)
-    {
-        /* release AdminQ */
-        status = _ice_release_adminq(adapter);
-        if(status != DDP_SUCCESS)
+        case ice_csr_state_done:
         {
-            debug_ddp_print("_ice_release_adminq error 0x%X\n", status);
+            return FALSE;
         }
     }
 
-    return status;
+    return TRUE;
 }
 
-ddp_status_t
-_ice_check_fw_version(adapter_t* adapter, bool* is_fw_supported, ddp_descriptor_t* dscr)
+/* Function runs the CSR machines of all adapters in a single threaded event loop. Steps of
+ * different devices are interleaved, so the time spent waiting for one device's FW is used
+ * by the others. Machines of the same device are chained and run one after another. The loop
+ * sleeps only when all machines wait for their next poll.
+ *
+ * Parameters:
+ * [in,out] machines            Array of CSR machines
+ * [in]     number_of_machines  Number of machines
+ *
+ * Returns: None
+ */
+void
+_ice_run_csr_machines(ice_csr_machine_t* machines, uint32_t number_of_machines)
 {
-    ddp_status_t       status             = DDP_SUCCESS;
-    adminq_desc_t*     descriptor         = (adminq_desc_t*)dscr->descriptor;
-    ice_aqc_get_ver_t* get_version        = NULL;
+    uint64_t now             = 0;
+    uint64_t next_wakeup     = 0;
+    uint32_t i               = 0;
+    uint32_t active_machines = 0;
+    bool     progressed      = FALSE;
 
-    do
+    while(TRUE)
     {
-        descriptor->opcode  = ICE_ADMINQ_COMMAND_GET_VERSION;
-        descriptor->flags   = ICE_AQ_FLAG_SI;
-        descriptor->datalen = 0;
+        now             = _ice_get_time_us();
+        next_wakeup     = UINT64_MAX;
+        active_machines = 0;
+        progressed      = FALSE;
 
-        status = _ice_get_data_by_csr(adapter, descriptor, NULL, 0);
-        if(status != DDP_SUCCESS)
+        for(i = 0; i < number_of_machines; i++)
         {
-            debug_ddp_print("ice_csr_get_profile_info error: 0x%X\n", status);
-            break;
-        }
-
-        get_version = (ice_aqc_get_ver_t*)descriptor->params.raw;
+            if(machines[i].state == ice_csr_state_done)
+            {
+                continue;
+            }
+            active_machines++;
 
-        debug_ddp_print("fw version: 0x%X 0x%X 0x%X 0x%X 0x%X\n",
-                        get_version->fw_branch,
-                        get_version->fw_major,
-                        get_version->fw_minor,
-                        get_version->fw_patch,
-                        get_version->fw_build);
+            if(_ice_step_csr_machine(&machines[i], now) == TRUE)
+            {
+                progressed = TRUE;
+                now = _ice_get_time_us();
+            }
+            if(machines[i].state == ice_csr_state_poll && machines[i].next_poll < next_wakeup)
+            {
+                next_wakeup = machines[i].next_poll;
+            }
+        }
 
-        if(get_version->fw_major > ICE_MIN_FW_VERSION_MAJOR)
+        if(active_machines == 0)
         {
-            *is_fw_supported = TRUE;
+            break;
         }
-        else if(get_version->fw_major == ICE_MIN_FW_VERSION_MAJOR  &&
-                get_version->fw_minor >  ICE_MIN_FW_VERSION_MINOR)
+
+        now = _ice_get_time_us();
+        if(progressed == FALSE && next_wakeup != UINT64_MAX && next_wakeup > now)
         {
-            *is_fw_supported = TRUE;
+            usleep((useconds_t)(next_wakeup - now));
         }
-        else if(get_version->fw_major == ICE_MIN_FW_VERSION_MAJOR  &&
-                get_version->fw_minor == ICE_MIN_FW_VERSION_MINOR  &&
-                get_version->fw_patch >= ICE_MIN_FW_VERSION_PATCH)
+    }
+}
+
+/* Callback of the DevLink INFO_GET dump - adds profile information of one device to the map */
+qdl_status_t
+_ice_add_devlink_info(unsigned int segment,
+                      unsigned int bus,
+                      unsigned int device,
+                      unsigned int function,
+                      uint8_t*     msg,
+                      unsigned int msg_size,
+                      void*        context)
+{
+    qdl_msg_index_t         index;
+    ice_devlink_info_map_t* map      = (ice_devlink_info_map_t*)context;
+    ice_devlink_info_t*     entries  = NULL;
+    ice_devlink_info_t*     info     = NULL;
+    uint32_t                capacity = 0;
+
+    /* the map grows geometrically, so the whole dump is stored in amortized O(n) */
+    if(map->number_of_entries == map->capacity)
+    {
+        capacity = (map->capacity == 0) ? ICE_DEVLINK_INFO_MAP_INITIAL_SIZE : map->capacity * 2;
+        entries  = realloc(map->entries, sizeof(ice_devlink_info_t) * capacity);
+        if(entries == NULL)
         {
-            *is_fw_supported = TRUE;
+            return QDL_MEMORY_ERROR;
         }
-    } while(0);
+        map->entries  = entries;
+        map->capacity = capacity;
+    }
 
-    return status;
+    info = &map->entries[map->number_of_entries];
+    MEMINIT(info);
+
+    info->location.segment  = segment;
+    info->location.bus      = bus;
+    info->location.device   = device;
+    info->location.function = function;
+
+    if(qdl_index_msg(msg, msg_size, &index) == QDL_SUCCESS)
+    {
+        qdl_get_indexed_string_by_key(&index, "fw.app.name", info->name, DDP_PROFILE_NAME_LENGTH);
+        qdl_get_indexed_string_by_key(&index, "fw.app", info->version, DDP_VERSION_LENGTH);
+        qdl_get_indexed_string_by_key(&index, "fw.app.bundle_id", info->track_id, DDP_TRACKID_LENGTH);
+    }
+    map->number_of_entries++;
+
+    return QDL_SUCCESS;
 }
 
-ddp_status_t
-_ice_get_adminq_ddp_profile_list(adapter_t* adapter, ddp_descriptor_t* dscr)
+int
+_ice_compare_devlink_info(const void* first, const void* second)
 {
-    ice_profiles_info_t  profiles_info;
-    ddp_status_t         status         = DDP_SUCCESS;
-    adminq_desc_t*       descriptor     = (adminq_desc_t*)dscr->descriptor;
-    uint8_t              profile_number = 0;
+    const device_location_t* a = &((const ice_devlink_info_t*)first)->location;
+    const device_location_t* b = &((const ice_devlink_info_t*)second)->location;
 
-    MEMINIT(&profiles_info);
+    if(a->segment != b->segment)
+    {
+        return (a->segment < b->segment) ? -1 : 1;
+    }
+    if(a->bus != b->bus)
+    {
+        return (a->bus < b->bus) ? -1 : 1;
+    }
+    if(a->device != b->device)
+    {
+        return (a->device < b->device) ? -1 : 1;
+    }
 
-    debug_ddp_print("Trying to read profile by AdminQ inteface.\n");
+    return (a->function < b->function) ? -1 : (a->function > b->function);
+}
 
-    do
+/* Function releases the DevLink info map */
+void
+ice_release_devlink_info_map(void)
+{
+    free_memory(ice_devlink_info_map.entries);
+    MEMINIT(&ice_devlink_info_map);
+}
+
+/* Function reads profile information of all DevLink devices with a single INFO_GET dump. The dump
+ * is done once per run, if it fails the devices are queried one by one. Must be called with
+ * ice_devlink_lock held.
+ *
+ * Parameters: None
+ *
+ * Returns: None
+ */
+void
+_ice_load_devlink_info_map(void)
+{
+    qdl_status_t qdl_status = QDL_SUCCESS;
+
+    if(ice_devlink_info_map_loaded == TRUE)
     {
-        descriptor->opcode  = ICE_ADMINQ_COMMAND_GET_DDP_PROFILE_LIST;
-        descriptor->flags   = ICE_AQ_FLAG_BUF | ICE_AQ_FLAG_SI;
-        descriptor->datalen = sizeof profiles_info;
+        return;
+    }
+    ice_devlink_info_map_loaded = TRUE;
 
-        status = _ice_get_data_by_csr(adapter, descriptor, (uint8_t*)&profiles_info, sizeof profiles_info);
-        if(status != DDP_SUCCESS)
-        {
-            debug_ddp_print("ice_get_data_by_basedriver 0x%X", status);
-            break;
-        }
+    qdl_status = qdl_dump_dev_info(_ice_add_devlink_info, &ice_devlink_info_map);
+    if(qdl_status != QDL_SUCCESS)
+    {
+        debug_ddp_print("DevLink INFO_GET dump error 0x%X, devices will be queried one by one\n", qdl_status);
+        ice_release_devlink_info_map();
+        return;
+    }
 
-        /* Copy data from ICE strcute to the generic tool structure */
-        if(profiles_info.count == 0)
-        {
-            status = DDP_NO_DDP_PROFILE;
-            break;
-        }
+    /* entries are looked up by binary search */
+    qsort(ice_devlink_info_map.entries,
+          ice_devlink_info_map.number_of_entries,
+          sizeof(ice_devlink_info_t),
+          _ice_compare_devlink_info);
+    ice_devlink_info_map_valid = TRUE;
 
-        debug_ddp_print("Found %d profile(s)\n", profiles_info.count);
+    debug_ddp_print("DevLink INFO_GET dump reported %d devices\n", ice_devlink_info_map.number_of_entries);
+}
 
-        adapter->profile_info.section_size = profiles_info.count;
-        for(profile_number = 0; profile_number < ICE_PROFILES_NUMBER; profile_number++)
-        {
-            debug_ddp_print("Profile: %d:\n", profile_number);
-            debug_ddp_print("  IsActive: %d\n", profiles_info.profile[profile_number].is_active);
-            debug_ddp_print("  Name:     %s\n", profiles_info.profile[profile_number].name);
-            debug_ddp_print("  TrackId:  %x\n", profiles_info.profile[profile_number].track_id);
-            /* The tool shall reports only active profile */
-            if(profiles_info.profile[profile_number].is_active == TRUE)
-            {
-                adapter->profile_info.version      = profiles_info.profile[profile_number].version;
-                adapter->profile_info.track_id     = profiles_info.profile[profile_number].track_id;
-                memcpy_sec(adapter->profile_info.name,
-                           DDP_PROFILE_NAME_LENGTH,
-                           profiles_info.profile[profile_number].name,
-                           ICE_PROFILE_NAME_LENGTH);
-                break;
-            }
-        }
-    } while (0);
+/* Function finds adapter in the DevLink info map. For virtual function the PF entry is returned.
+ *
+ * Parameters:
+ * [in] adapter  Adapter to find
+ *
+ * Returns: Map entry or NULL if the adapter is not reported by the DevLink dump.
+ */
+ice_devlink_info_t*
+_ice_find_devlink_info(adapter_t* adapter)
+{
+    ice_devlink_info_t key;
 
-    return status;
+    if(ice_devlink_info_map.number_of_entries == 0)
+    {
+        return NULL;
+    }
+
+    key.location = (adapter->is_virtual_function == TRUE) ? adapter->pf_location : adapter->location;
+
+    return (ice_devlink_info_t*)bsearch(&key,
+                                        ice_devlink_info_map.entries,
+                                        ice_devlink_info_map.number_of_entries,
+                                        sizeof(ice_devlink_info_t),
+                                        _ice_compare_devlink_info);
+}
+
+/* Function sets profile information of adapter from strings reported by DevLink */
+void
+_ice_set_devlink_profile_info(adapter_t* adapter, ice_devlink_info_t* info)
+{
+    ddp_profile_version_t* version = &adapter->profile_info.version;
+
+    strcpy_sec(adapter->profile_info.name,
+               DDP_PROFILE_NAME_LENGTH,
+               info->name,
+               strnlen(info->name, DDP_PROFILE_NAME_LENGTH - 1));
+
+    sscanf(info->version,
+           "%hhu.%hhu.%hhu.%hhu",
+           &version->major,
+           &version->minor,
+           &version->update,
+           &version->draft);
+
+    sscanf(info->track_id, "%X", &adapter->profile_info.track_id);
+    /* The AdminQ respons include the section size - this value is usefull to correct display the table
+     * For DevLink this sections doesn't exists, let's set the dummy value (greater than 0).
+     */
+    adapter->profile_info.section_size = 1;
 }
 
+/* Function reads profile information by DevLink. If the adapter is reported by the INFO_GET dump
+ * the map entry is used, otherwise INFO_GET is sent for the descriptor.
+ *
+ * Parameters:
+ * [in,out] adapter  Adapter to discover
+ * [in]     dscr     DevLink descriptor, may be NULL if the adapter is in the DevLink info map
+ *
+ * Returns: DDP_SUCCESS if succeeds, otherwise error code.
+ */
 ddp_status_t
 _ice_get_devlink_profile_info(adapter_t* adapter, ddp_descriptor_t* dscr)
 {
-    char                   profile_version[DDP_VERSION_LENGTH];
-    char                   track_id[DDP_TRACKID_LENGTH];
-    qdl_dscr_t             qdl_descriptor = (qdl_dscr_t)dscr->descriptor;
-    ddp_profile_version_t* version        = &adapter->profile_info.version;
-    uint8_t*               msg            = 0;
+    qdl_msg_index_t        index;
+    ice_devlink_info_t     info;
+    uint32_t               msg[QDL_MSG_SIZE_INFO_GET / sizeof(uint32_t)];
+    ice_devlink_info_t*    map_info       = NULL;
+    qdl_dscr_t             qdl_descriptor = NULL;
     uint8_t*               rec_msg        = 0;
+    uint8_t*               info_msg       = NULL;
     ddp_status_t           status         = DDP_SUCCESS;
     qdl_status_t           qdl_status     = QDL_SUCCESS;
     uint32_t               msg_size       = 0;
     uint32_t               rec_msg_size   = QDL_REC_BUFF_SIZE;
+    uint32_t               info_msg_size  = 0;
 
-    memset(profile_version, '\0', DDP_VERSION_LENGTH);
-    memset(track_id, '\0', DDP_TRACKID_LENGTH);
+    MEMINIT(&info);
 
     debug_ddp_print("Trying to read profile by DevLink inteface.\n");
 
@@ -613,78 +1018,112 @@ _ice_get_devlink_profile_info(adapter_t* adapter, ddp_descriptor_t* dscr)
             break;
         }
 
-        msg = qdl_create_msg(qdl_descriptor, QDL_CMD_INFO_GET, &msg_size, NULL);
-        if(msg == NULL)
+        map_info = _ice_find_devlink_info(adapter);
+        if(map_info != NULL)
         {
-            debug_ddp_print("qdl_create_msg error\n");
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+            debug_ddp_print("Profile read from DevLink INFO_GET dump\n");
+            _ice_set_devlink_profile_info(adapter, map_info);
             break;
         }
 
-        qdl_status = qdl_send_msg(qdl_descriptor, msg, msg_size);
-        if(qdl_status != QDL_SUCCESS)
+        if(dscr == NULL || dscr->descriptor_type != descriptor_devlink)
         {
-            debug_ddp_print("qdl_send_msg error 0x%X\n", qdl_status);
             status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             break;
         }
+        qdl_descriptor = (qdl_dscr_t)dscr->descriptor;
 
-        rec_msg = malloc_sec(rec_msg_size);
-        if(rec_msg == NULL)
+        /* INFO_GET reply read by the devlink support probe is reused if available */
+        qdl_status = qdl_get_info_snapshot(qdl_descriptor, &info_msg, &info_msg_size);
+        if(qdl_status != QDL_SUCCESS)
         {
-            debug_ddp_print("memory allocate error\n");
-            status = DDP_ALLOCATE_MEMORY_FAIL;
-            break;
+            qdl_status = qdl_build_msg(qdl_descriptor, QDL_CMD_INFO_GET, NULL, (uint8_t*)msg, sizeof(msg), &msg_size);
+            if(qdl_status != QDL_SUCCESS)
+            {
+                debug_ddp_print("qdl_build_msg error 0x%X\n", qdl_status);
+                status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+                break;
+            }
+
+            qdl_status = qdl_send_msg(qdl_descriptor, (uint8_t*)msg, msg_size);
+            if(qdl_status != QDL_SUCCESS)
+            {
+                debug_ddp_print("qdl_send_msg error 0x%X\n", qdl_status);
+                status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+                break;
+            }
+
+            rec_msg = malloc_sec(rec_msg_size);
+            if(rec_msg == NULL)
+            {
+                debug_ddp_print("memory allocate error\n");
+                status = DDP_ALLOCATE_MEMORY_FAIL;
+                break;
+            }
+
+            qdl_status = qdl_receive_msg(qdl_descriptor, rec_msg, &rec_msg_size);
+            if(qdl_status != QDL_SUCCESS)
+            {
+                debug_ddp_print("qdl_receive_msg error 0x%X\n", qdl_status);
+                status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+                break;
+            }
+            info_msg      = rec_msg;
+            info_msg_size = rec_msg_size;
         }
 
-        qdl_status = qdl_receive_msg(qdl_descriptor, rec_msg, &rec_msg_size);
-        if(qdl_status != QDL_SUCCESS)
+        /* The reply is parsed once, keys are found in the index */
+        qdl_status = qdl_index_dev_msg(qdl_descriptor, info_msg, info_msg_size, &index);
+        if(qdl_status == QDL_SUCCESS)
         {
-            debug_ddp_print("qdl_receive_msg error 0x%X\n", qdl_status);
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-            break;
+            qdl_get_indexed_string_by_key(&index, "fw.app.name", info.name, DDP_PROFILE_NAME_LENGTH);
+            qdl_get_indexed_string_by_key(&index, "fw.app", info.version, DDP_VERSION_LENGTH);
+            qdl_get_indexed_string_by_key(&index, "fw.app.bundle_id", info.track_id, DDP_TRACKID_LENGTH);
+        }
+        else
+        {
+            debug_ddp_print("qdl_index_dev_msg error 0x%X\n", qdl_status);
         }
 
-        qdl_get_string_by_key(qdl_descriptor,
-                              rec_msg,
-                              rec_msg_size,
-                              "fw.app.name",
-                              adapter->profile_info.name,
-                              DDP_PROFILE_NAME_LENGTH);
-
-        qdl_get_string_by_key(qdl_descriptor,
-                              rec_msg,
-                              rec_msg_size,
-                              "fw.app",
-                              profile_version,
-                              DDP_VERSION_LENGTH);
-        sscanf(profile_version,
-               "%hhu.%hhu.%hhu.%hhu",
-               &version->major,
-               &version->minor,
-               &version->update,
-               &version->draft);
-
-        qdl_get_string_by_key(qdl_descriptor, rec_msg, rec_msg_size, "fw.app.bundle_id", track_id, DDP_TRACKID_LENGTH);
-
-        sscanf(track_id, "%X", &adapter->profile_info.track_id);
-        /* The AdminQ respons include the section size - this value is usefull to correct display the table
-         * For DevLink this sections doesn't exists, let's set the dummy value (greater than 0).
-         */
-        adapter->profile_info.section_size = 1;
+        _ice_set_devlink_profile_info(adapter, &info);
     } while (0);
 
-    free_memory(msg);
     free_memory(rec_msg);
 
     return status;
 }
 
+/* Function creates the IOCTL (CSR adminQ) descriptor of adapter */
+void
+_ice_get_ioctl_descriptor(adapter_t* adapter, ddp_descriptor_t* dscr)
+{
+    adminq_desc_t* aq_descriptor = NULL;
+
+    dscr->descriptor_type = descriptor_none;
+
+    do
+    {
+        /* Check if name for Ethernet interface is available */
+        if(adapter->is_usable == FALSE)
+            break;
+
+        aq_descriptor = malloc_sec(sizeof(adminq_desc_t));
+        if(aq_descriptor == NULL)
+        {
+            debug_ddp_print("Cannot allocate buffer\n");
+            break;
+        }
+
+        debug_ddp_print("Tool will use the IOCTL interface for this device\n");
+        dscr->descriptor = aq_descriptor;
+        dscr->descriptor_type = descriptor_ioctl;
+    } while (0);
+}
+
 void
 _ice_get_adapter_descriptor(adapter_t* adapter, ddp_descriptor_t* dscr)
 {
-    qdl_dscr_t     qdl_descriptor = NULL;
-    adminq_desc_t* aq_descriptor  = NULL;
+    qdl_dscr_t qdl_descriptor = NULL;
 
     dscr->descriptor_type = descriptor_none;
 
@@ -697,7 +1136,7 @@ _ice_get_adapter_descriptor(adapter_t* adapter, ddp_descriptor_t* dscr)
                                           adapter->pf_location.bus,
                                           adapter->pf_location.device,
                                           adapter->pf_location.function,
-                                          QDL_INIT_NVM);
+                                          QDL_INIT_NVM | QDL_INIT_INFO_ONLY);
         }
         else
         {
@@ -705,7 +1144,7 @@ _ice_get_adapter_descriptor(adapter_t* adapter, ddp_descriptor_t* dscr)
                                           adapter->location.bus,
                                           adapter->location.device,
                                           adapter->location.function,
-                                          QDL_INIT_NVM);
+                                          QDL_INIT_NVM | QDL_INIT_INFO_ONLY);
         }
 
         if(qdl_descriptor != NULL)
@@ -716,20 +1155,7 @@ _ice_get_adapter_descriptor(adapter_t* adapter, ddp_descriptor_t* dscr)
             break;
         }
 
-        /* Check if name for Ethernet interface is available */
-        if(adapter->is_usable == FALSE)
-            break;
-
-        aq_descriptor = malloc_sec(sizeof(adminq_desc_t));
-        if(aq_descriptor == NULL)
-        {
-            debug_ddp_print("Cannot allocate buffer\n");
-            break;
-        }
-
-        debug_ddp_print("Tool will use the IOCTL interface for this device\n");
-        dscr->descriptor = aq_descriptor;
-        dscr->descriptor_type = descriptor_ioctl;
+        _ice_get_ioctl_descriptor(adapter, dscr);
     } while (0);
 }
 
@@ -746,76 +1172,391 @@ ice_release_descriptor(ddp_descriptor_t* dscr)
     }
 }
 
+/* Function sets the profile name of adapter which discovery failed */
 ddp_status_t
-_ice_discovery_device(adapter_t* adapter)
+_ice_finish_discovery(adapter_t* adapter, ddp_status_t status)
 {
-    ddp_descriptor_t descriptor;
-    ddp_status_t     status          = DDP_SUCCESS;
-    bool             is_fw_supported = FALSE;
+    if(status != DDP_SUCCESS               &&
+       status != DDP_NO_DDP_PROFILE        &&
+       status != DDP_NO_SUPPORTED_ADAPTER)
+    {
+        strcpy_sec(adapter->profile_info.name,
+                   DDP_PROFILE_NAME_LENGTH,
+                   EMPTY_MESSAGE,
+                   strlen(EMPTY_MESSAGE));
+    }
 
-    MEMINIT(&descriptor);
+    return status;
+}
+
+/* Function discovers ice adapters from the list of discovery jobs. Adapters accessible only by
+ * IOCTL are discovered by CSR machines interleaved in a single event loop. In batch mode only jobs
+ * claimed by ice_prepare_discovery_batch() are discovered and IOCTL is the only interface tried,
+ * otherwise the adapters are discovered from the DevLink info map, if it was loaded by the batch,
+ * or by their own descriptor.
+ *
+ * Parameters:
+ * [in,out] jobs            Array of discovery jobs
+ * [in]     number_of_jobs  Number of jobs
+ * [in]     is_batch        Discover only the jobs claimed by the batch
+ *
+ * Returns: None
+ */
+void
+_ice_discovery_jobs(discovery_job_t* jobs, uint32_t number_of_jobs, bool is_batch)
+{
+    ddp_descriptor_t   descriptor;
+    ice_csr_machine_t* machines           = NULL;
+    ice_csr_machine_t* machine            = NULL;
+    discovery_job_t*   job                = NULL;
+    adapter_t*         adapter            = NULL;
+    adapter_t*         other_adapter      = NULL;
+    device_location_t* location           = NULL;
+    device_location_t* other_location     = NULL;
+    ddp_status_t       status             = DDP_SUCCESS;
+    uint32_t           number_of_machines = 0;
+    uint32_t           i                  = 0;
+    uint32_t           j                  = 0;
 
     do
     {
-        _ice_get_adapter_descriptor(adapter, &descriptor);
-        if(descriptor.descriptor == NULL)
+        machines = malloc_sec(sizeof(ice_csr_machine_t) * number_of_jobs);
+        if(machines == NULL)
         {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             break;
         }
 
-        if(descriptor.descriptor_type == descriptor_ioctl)
+        for(i = 0; i < number_of_jobs; i++)
         {
-            status = _ice_check_fw_version(adapter, &is_fw_supported, &descriptor);
-            if(status != DDP_SUCCESS)
+            job = &jobs[i];
+            if(job->adapter == NULL || job->is_done == TRUE || (is_batch == TRUE && job->is_batched == FALSE))
             {
-                debug_ddp_print("Error when checking FW version for currently printed adapter\n");
-                break;
+                continue;
             }
+            adapter = job->adapter;
 
-            if(is_fw_supported == FALSE)
+            MEMINIT(&descriptor);
+
+            if(is_batch == TRUE)
             {
-                status = DDP_NO_SUPPORTED_ADAPTER;
-                strcpy_sec(adapter->profile_info.name,
-                           DDP_PROFILE_NAME_LENGTH,
-                           UNSUPPORTED_FW,
-                           strlen(UNSUPPORTED_FW));
-                break;
+                /* Not reported by a successful dump - the adapter has no DevLink interface */
+                _ice_get_ioctl_descriptor(adapter, &descriptor);
             }
-            status = _ice_get_adminq_ddp_profile_list(adapter, &descriptor);
-            if(status == DDP_NO_DDP_PROFILE)
+            else if(_ice_find_devlink_info(adapter) != NULL)
             {
-                strcpy_sec(adapter->profile_info.name,
-                           DDP_PROFILE_NAME_LENGTH,
-                           NO_PROFILE,
-                           strlen(NO_PROFILE));
+                /* Already reported by the INFO_GET dump - no descriptor is needed */
+                status = _ice_get_devlink_profile_info(adapter, NULL);
+
+                job->status  = _ice_finish_discovery(adapter, status);
+                job->is_done = TRUE;
+                continue;
+            }
+            else
+            {
+                _ice_get_adapter_descriptor(adapter, &descriptor);
+            }
+
+            if(descriptor.descriptor_type == descriptor_ioctl)
+            {
+                machine = &machines[number_of_machines];
+                machine->job             = job;
+                machine->descriptor      = (adminq_desc_t*)descriptor.descriptor;
+                machine->session.adapter = adapter;
+                machine->state           = ice_csr_state_acquire;
+
+                /* chain machines of the same device - it has one adminQ lock */
+                location = (adapter->is_virtual_function == TRUE) ? &adapter->pf_location : &adapter->location;
+                for(j = number_of_machines; j > 0; j--)
+                {
+                    other_adapter  = machines[j - 1].session.adapter;
+                    other_location = (other_adapter->is_virtual_function == TRUE) ? &other_adapter->pf_location :
+                                                                                    &other_adapter->location;
+                    if(other_location->segment == location->segment && other_location->bus == location->bus)
+                    {
+                        machine->previous = &machines[j - 1];
+                        break;
+                    }
+                }
+                number_of_machines++;
+                continue;
+            }
+
+            if(descriptor.descriptor_type == descriptor_devlink)
+            {
+                status = _ice_get_devlink_profile_info(adapter, &descriptor);
             }
+            else
+            {
+                debug_ddp_print("Cannot create interface descriptor\n");
+                status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+            }
+            ice_release_descriptor(&descriptor);
+
+            job->status  = _ice_finish_discovery(adapter, status);
+            job->is_done = TRUE;
         }
-        else if(descriptor.descriptor_type == descriptor_devlink)
+
+        _ice_run_csr_machines(machines, number_of_machines);
+
+        for(i = 0; i < number_of_machines; i++)
         {
-            status = _ice_get_devlink_profile_info(adapter, &descriptor);
+            adapter = machines[i].session.adapter;
+            machines[i].job->status  = _ice_finish_discovery(adapter, machines[i].status);
+            machines[i].job->is_done = TRUE;
+            free_memory(machines[i].descriptor);
+            close_ioctl_transport(adapter);
         }
-        else
+    } while(0);
+
+    free_memory(machines);
+
+    /* jobs which could not be discovered */
+    for(i = 0; i < number_of_jobs; i++)
+    {
+        job = &jobs[i];
+        if(job->adapter != NULL && job->is_done == FALSE && (is_batch == FALSE || job->is_batched == TRUE))
         {
-            debug_ddp_print("Cannot create interface descriptor\n");
+            job->status  = _ice_finish_discovery(job->adapter, DDP_ALLOCATE_MEMORY_FAIL);
+            job->is_done = TRUE;
         }
-    } while(0);
+    }
+}
 
-    if(status != DDP_SUCCESS               &&
-       status != DDP_NO_DDP_PROFILE        &&
-       status != DDP_NO_SUPPORTED_ADAPTER)
+/* Function writes one chunk of the region dump to the output stream */
+qdl_status_t
+_ice_write_region_chunk(UNUSED uint64_t address, uint8_t* data, unsigned int data_size, void* context)
+{
+    ice_region_dump_t* dump = (ice_region_dump_t*)context;
+
+    if(fwrite(data, 1, data_size, dump->stream) != data_size)
     {
-        strcpy_sec(adapter->profile_info.name,
-                   DDP_PROFILE_NAME_LENGTH,
-                   EMPTY_MESSAGE,
-                   strlen(EMPTY_MESSAGE));
+        dump->write_failed = TRUE;
+        return QDL_INVALID_PARAMS;
     }
+    dump->bytes_written += data_size;
 
-    ice_release_descriptor(&descriptor);
+    return QDL_SUCCESS;
+}
+
+/* Function dumps DevLink region of the adapter to the stream. Snapshot of the region is taken
+ * once and read in ICE_REGION_DUMP_WINDOW_SIZE windows; every chunk is written as soon as its
+ * dump message is received, so memory usage does not depend on the region size.
+ *
+ * Parameters:
+ * [in]     adapter  Handle to adapter
+ * [in]     region   Region to dump (DDP_DUMP_REGION_FLASH or DDP_DUMP_REGION_CAPS)
+ * [in,out] dump     Output stream on entry, dump statistics on exit
+ *
+ * Returns: DDP status.
+ */
+ddp_status_t
+ice_dump_region(adapter_t* adapter, char* region, ice_region_dump_t* dump)
+{
+    device_location_t* location       = NULL;
+    qdl_dscr_t         qdl_descriptor = NULL;
+    char*              region_name    = NULL;
+    ddp_status_t       status         = DDP_SUCCESS;
+    qdl_status_t       qdl_status     = QDL_SUCCESS;
+    uint64_t           start_time     = 0;
+    uint64_t           address        = 0;
+    uint64_t           length         = 0;
+    uint32_t           flags          = QDL_INIT_INFO_ONLY;
+
+    if(adapter == NULL || region == NULL || dump == NULL || dump->stream == NULL)
+    {
+        return DDP_INCORRECT_FUNCTION_PARAMETERS;
+    }
+
+    if(strcmp(region, DDP_DUMP_REGION_FLASH) == 0)
+    {
+        region_name = QDL_REGION_NAME_FLASH;
+        flags      |= QDL_INIT_NVM;
+    }
+    else if(strcmp(region, DDP_DUMP_REGION_CAPS) == 0)
+    {
+        region_name = QDL_REGION_NAME_CAPS;
+        flags      |= QDL_INIT_CAPS;
+    }
+    else
+    {
+        return DDP_INCORRECT_FUNCTION_PARAMETERS;
+    }
+
+    /* For virtual function the tool shall use the PF location to read data */
+    location = (adapter->is_virtual_function == TRUE) ? &adapter->pf_location : &adapter->location;
+
+    do
+    {
+        qdl_descriptor = qdl_init_dev(location->segment,
+                                      location->bus,
+                                      location->device,
+                                      location->function,
+                                      flags);
+        if(qdl_descriptor == NULL)
+        {
+            debug_ddp_print("Region dump requires the DevLink interface\n");
+            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
+            break;
+        }
+
+        qdl_status = qdl_get_region_size(qdl_descriptor, region_name, &dump->region_size);
+        if(qdl_status != QDL_SUCCESS || dump->region_size == 0)
+        {
+            debug_ddp_print("qdl_get_region_size error: %d\n", qdl_status);
+            status = DDP_CANNOT_READ_DEVICE_DATA;
+            break;
+        }
+        debug_ddp_print("Region %s size: %llu bytes\n", region_name, (unsigned long long)dump->region_size);
+
+        start_time = _ice_get_time_us();
+        for(address = 0; address < dump->region_size; address += length)
+        {
+            length = dump->region_size - address;
+            if(length > ICE_REGION_DUMP_WINDOW_SIZE)
+            {
+                length = ICE_REGION_DUMP_WINDOW_SIZE;
+            }
+
+            qdl_status = qdl_read_region_stream(qdl_descriptor,
+                                                region_name,
+                                                address,
+                                                length,
+                                                _ice_write_region_chunk,
+                                                dump);
+            if(qdl_status != QDL_SUCCESS)
+            {
+                debug_ddp_print("qdl_read_region_stream error: %d at 0x%llX\n",
+                                qdl_status,
+                                (unsigned long long)address);
+                status = (dump->write_failed == TRUE) ? DDP_CANNOT_CREATE_OUTPUT_FILE : DDP_CANNOT_READ_DEVICE_DATA;
+                break;
+            }
+            dump->number_of_windows++;
+        }
+
+        if(status == DDP_SUCCESS && fflush(dump->stream) != 0)
+        {
+            status = DDP_CANNOT_CREATE_OUTPUT_FILE;
+        }
+        dump->elapsed_time = _ice_get_time_us() - start_time;
+    } while(0);
+
+    if(qdl_descriptor != NULL)
+    {
+        qdl_release_dev(qdl_descriptor);
+    }
 
     return status;
 }
 
+ddp_status_t
+_ice_discovery_device(adapter_t* adapter)
+{
+    discovery_job_t job;
+
+    MEMINIT(&job);
+    job.adapter = adapter;
+
+    _ice_discovery_jobs(&job, 1, FALSE);
+
+    return job.status;
+}
+
+/* Function checks if the discovery job is a pending job of an ice adapter */
+bool
+_ice_is_pending_job(discovery_job_t* job)
+{
+    if(job->adapter == NULL || job->is_done == TRUE || job->copy_from_previous == TRUE ||
+       job->adapter->selector_status != DDP_SUCCESS ||
+       job->adapter->tdi.discovery_device != _ice_discovery_device)
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Function prepares the batch discovery of pending ice adapters. The DevLink INFO_GET dump is read
+ * only if there are at least two pending ice adapters - a single adapter is cheaper to query by its
+ * own descriptor. Adapters reported by the dump are discovered from it. Adapters missing from a successful dump have no
+ * DevLink interface - their jobs are claimed by the batch, so their adminQ commands are interleaved
+ * by ice_run_discovery_batch(). Adapters which need their own DevLink descriptor stay pending for
+ * the discovery workers.
+ *
+ * Parameters:
+ * [in,out] jobs            Array of discovery jobs
+ * [in]     number_of_jobs  Number of jobs
+ *
+ * Returns: Number of jobs claimed by the batch.
+ */
+uint32_t
+ice_prepare_discovery_batch(discovery_job_t* jobs, uint32_t number_of_jobs)
+{
+    discovery_job_t* job               = NULL;
+    adapter_t*       adapter           = NULL;
+    ddp_status_t     status            = DDP_SUCCESS;
+    uint32_t         number_of_batched = 0;
+    uint32_t         number_of_pending = 0;
+    uint32_t         i                 = 0;
+
+    for(i = 0; i < number_of_jobs; i++)
+    {
+        if(_ice_is_pending_job(&jobs[i]) == TRUE)
+        {
+            number_of_pending++;
+        }
+    }
+    if(number_of_pending < 2)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ice_devlink_lock);
+    _ice_load_devlink_info_map();
+    pthread_mutex_unlock(&ice_devlink_lock);
+
+    for(i = 0; i < number_of_jobs; i++)
+    {
+        job = &jobs[i];
+        if(_ice_is_pending_job(job) == FALSE)
+        {
+            continue;
+        }
+        adapter = job->adapter;
+
+        if(_ice_find_devlink_info(adapter) != NULL)
+        {
+            /* Already reported by the INFO_GET dump - no descriptor is needed */
+            status = _ice_get_devlink_profile_info(adapter, NULL);
+
+            job->status  = _ice_finish_discovery(adapter, status);
+            job->is_done = TRUE;
+        }
+        else if(ice_devlink_info_map_valid == TRUE)
+        {
+            job->is_batched = TRUE;
+            number_of_batched++;
+        }
+    }
+
+    return number_of_batched;
+}
+
+/* Function discovers the ice adapters claimed by ice_prepare_discovery_batch(). It is run as a
+ * single job of the discovery pool, so the CSR event loop runs next to the discovery workers.
+ *
+ * Parameters:
+ * [in,out] jobs            Array of discovery jobs
+ * [in]     number_of_jobs  Number of jobs
+ *
+ * Returns: None
+ */
+void
+ice_run_discovery_batch(discovery_job_t* jobs, uint32_t number_of_jobs)
+{
+    _ice_discovery_jobs(jobs, number_of_jobs, TRUE);
+}
+
 ddp_status_t
 _100g_verify_driver(char* driver_name, driver_os_version_t* ice_driver_version)
 {
@@ -24,8 +24,11 @@
 *************************************************************************************************************/
 
 #include "os.h"
+#include "qdl_i.h"
 #include <ctype.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 #define PATH_BUFFER_SIZE 300
 
@@ -328,71 +331,98 @@ get_data_from_sysfs_files(adapter_t* adapter)
 ddp_status_t
 get_data_from_sysfs_config(adapter_t* adapter)
 {
-    pci_config_space_t pci_config_space;
-    char               path_to_config_file[300];
-    FILE*              config                   = NULL;
-    ddp_status_t       status                   = DDP_SUCCESS;
-    uint16_t           length                   = 0;
-    uint8_t            i                        = 0;
-    size_t             read_size                = 0;
-
-    MEMINIT(&path_to_config_file);
+    qdl_pci_config_space_t pci_config_space;
+    ddp_status_t           status           = DDP_SUCCESS;
+    unsigned int           read_size        = 0;
+
     MEMINIT(&pci_config_space);
 
     do
     {
-        snprintf(path_to_config_file,
-                 sizeof(path_to_config_file),
-                 "%s/%04x:%02x:%02x.%d/config",
-                 PATH_TO_SYSFS_PCI,
-                 adapter->location.segment,
-                 adapter->location.bus,
-                 adapter->location.device,
-                 adapter->location.function);
-
-        config = fopen(path_to_config_file, "rb");
-        if(config == NULL)
+        /* config space is shared with the devlink module and read only once per device */
+        read_size = qdl_read_pci_config_space(adapter->location.segment,
+                                              adapter->location.bus,
+                                              adapter->location.device,
+                                              adapter->location.function,
+                                              &pci_config_space);
+        if(read_size < sizeof(pci_config_space_t))
         {
             status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             break;
         }
 
-        /* get file size */
-        fseek(config, 0, SEEK_END);
-        length = ftell(config);
+        adapter->vendor_id = pci_config_space.vendor_id;
+        adapter->device_id = pci_config_space.device_id;
+        adapter->subdevice_id = pci_config_space.subsystem_id;
+        adapter->subvendor_id = pci_config_space.subsystem_vendor_id;
+    } while(0);
+
+    return status;
+}
+
+/* Function is_intel_network_function() is a cheap first stage filter used before
+ * any deep probing of the device. It checks only the vendor ID and the class code
+ * from the PCI config space header. The header is read once and cached, so the later
+ * get_data_from_sysfs_config() call doesn't touch sysfs again. Virtual functions
+ * report 0xFFFF as vendor ID in config space, so for them the vendor sysfs file is used.
+ *
+ * Parameters:
+ * [in] location     PCI location of the function
+ *
+ * Returns: FALSE if function is surely not an Intel network device, TRUE otherwise
+ *          (also when config space cannot be read - the full path decides then).
+ */
+bool
+is_intel_network_function(device_location_t* location)
+{
+    qdl_pci_config_space_t pci_config_space;
+    char                   path_to_device_file[PATH_BUFFER_SIZE];
+    uint16_t               vendor_id                              = 0;
+    unsigned int           read_size                              = 0;
+    bool                   is_candidate                           = TRUE;
+
+    MEMINIT(&path_to_device_file);
+    MEMINIT(&pci_config_space);
 
-        if(length < sizeof pci_config_space)
+    do
+    {
+        read_size = qdl_read_pci_config_space(location->segment,
+                                              location->bus,
+                                              location->device,
+                                              location->function,
+                                              &pci_config_space);
+        if(read_size < DDP_PCI_PREFILTER_SIZE)
         {
-            status = DDP_CANNOT_COMMUNICATE_ADAPTER;
             break;
         }
 
-        rewind(config);
-
-        for(i = 0; i < sizeof pci_config_space; i++)
+        if(pci_config_space.class_code != DDP_PCI_CLASS_NETWORK)
         {
-            read_size = fread((uint8_t*) (&pci_config_space) + i, 1, 1, config);
-            if(read_size != 1)
-            {
-                status = DDP_CANNOT_COMMUNICATE_ADAPTER;
-                break;
-            }
+            is_candidate = FALSE;
+            break;
         }
-        if(status != DDP_SUCCESS)
+
+        vendor_id = pci_config_space.vendor_id;
+        if(vendor_id == 0xFFFF)
         {
-            break;
+            snprintf(path_to_device_file,
+                     sizeof(path_to_device_file),
+                     "%s/%04x:%02x:%02x.%d/vendor",
+                     PATH_TO_SYSFS_PCI,
+                     location->segment,
+                     location->bus,
+                     location->device,
+                     location->function);
+            vendor_id = get_uint16_t_from_file(path_to_device_file);
         }
 
-        adapter->vendor_id = pci_config_space.vendor_id;
-        adapter->device_id = pci_config_space.device_id;
-        adapter->subdevice_id = pci_config_space.subsystem_device_id;
-        adapter->subvendor_id = pci_config_space.subsystem_vendor_id;
+        if(vendor_id != DDP_PCI_VENDOR_ID_INTEL)
+        {
+            is_candidate = FALSE;
+        }
     } while(0);
 
-    if(config != NULL)
-        fclose(config);
-
-    return status;
+    return is_candidate;
 }
 
 ddp_status_t
@@ -441,13 +471,144 @@ get_driver_version_from_os(driver_os_version_t* driver_version, char* version_fi
     return ddp_status;
 }
 
-/* Functions looks up 2-PartId/4-PartId in pci.ids and collects a branding string for current adapter
+/* pci.ids is mapped once per run and indexed for a single vendor section */
+static char*                  pci_ids_data       = NULL;
+static size_t                 pci_ids_size       = 0;
+static bool                   pci_ids_mapped     = FALSE; /* mapping already attempted */
+static ddp_status_t           pci_ids_status     = DDP_SUCCESS;
+static struct stat            pci_ids_stat;
+static pci_ids_index_header_t pci_ids_header;
+static pci_ids_device_t*      pci_ids_devices    = NULL;
+static pci_ids_subsystem_t*   pci_ids_subsystems = NULL;
+static bool                   pci_ids_indexed    = FALSE;
+static pci_ids_memo_t*        pci_ids_memo          = NULL;
+static uint32_t               pci_ids_memo_count    = 0;
+static uint32_t               pci_ids_memo_capacity = 0;
+
+/* Function map_pci_ids() maps pci.ids file into memory. Mapping is attempted only once per run.
+ *
+ * Returns: DDP_SUCCESS if file is mapped or DDP_FILE_ACCESS_ERROR otherwise.
+ */
+ddp_status_t
+map_pci_ids(void)
+{
+    void* data            = MAP_FAILED;
+    int   file_descriptor = -1;
+
+    do
+    {
+        if(pci_ids_mapped == TRUE)
+        {
+            break;
+        }
+        pci_ids_mapped = TRUE;
+        pci_ids_status = DDP_FILE_ACCESS_ERROR;
+
+        file_descriptor = open(PATH_TO_PCI_IDS, O_RDONLY | O_CLOEXEC);
+        if(file_descriptor < 0)
+        {
+            break;
+        }
+
+        if(fstat(file_descriptor, &pci_ids_stat) != 0 || S_ISREG(pci_ids_stat.st_mode) == 0 ||
+           pci_ids_stat.st_size <= 0 || (uint64_t)pci_ids_stat.st_size >= UINT32_MAX)
+        {
+            debug_ddp_print("Cannot use %s file\n", PATH_TO_PCI_IDS);
+            break;
+        }
+
+        data = mmap(NULL, (size_t)pci_ids_stat.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if(data == MAP_FAILED)
+        {
+            debug_ddp_print("Cannot map %s file, error: %d\n", PATH_TO_PCI_IDS, errno);
+            break;
+        }
+
+        pci_ids_data   = (char*)data;
+        pci_ids_size   = (size_t)pci_ids_stat.st_size;
+        pci_ids_status = DDP_SUCCESS;
+    } while(0);
+
+    if(file_descriptor >= 0)
+    {
+        close(file_descriptor);
+    }
+
+    return pci_ids_status;
+}
+
+/* Function get_pci_ids_line() finds the end of the line starting at given offset of mapped pci.ids
  *
  * Parameters:
- * [in, out] adapter     ddp adapter struct - branding string written to adapter->branding_string
- * [out]    match_level  4 if 4-PartId match, 2 if 2-PartId match, 0 if no match
+ * [in]  offset       Offset of the line
+ * [out] line_length  Length of the line without new line character
  *
- * Returns: success if no issues or error code otherwise
+ * Returns: Offset of the next line.
+ */
+uint32_t
+get_pci_ids_line(uint32_t offset, uint32_t* line_length)
+{
+    char* line_end = memchr(pci_ids_data + offset, '\n', pci_ids_size - offset);
+
+    if(line_end == NULL)
+    {
+        *line_length = (uint32_t)(pci_ids_size - offset);
+        return (uint32_t)pci_ids_size;
+    }
+
+    *line_length = (uint32_t)(line_end - (pci_ids_data + offset));
+
+    return offset + *line_length + 1;
+}
+
+/* Function parse_pci_ids_id() converts up to 4 hex digits at the beginning of given text */
+uint16_t
+parse_pci_ids_id(const char* text, uint32_t text_length)
+{
+    uint16_t id = 0;
+    uint32_t i  = 0;
+
+    for(i = 0; i < DDP_ID_BUFFER_SIZE - 1 && i < text_length && isxdigit((unsigned char)text[i]) != 0; i++)
+    {
+        id <<= 4;
+        id |= (uint16_t)(isdigit((unsigned char)text[i]) != 0 ? text[i] - '0' : tolower((unsigned char)text[i]) - 'a' + 10);
+    }
+
+    return id;
+}
+
+/* Function get_pci_ids_name() returns location of the name placed at given position of pci.ids line */
+void
+get_pci_ids_name(uint32_t line_offset, uint32_t line_length, uint32_t name_position, uint32_t* name_offset, uint32_t* name_length)
+{
+    if(line_length > name_position)
+    {
+        *name_offset = line_offset + name_position;
+        *name_length = line_length - name_position;
+    }
+    else
+    {
+        *name_offset = line_offset + line_length;
+        *name_length = 0;
+    }
+}
+
+int
+compare_pci_ids_device(const void* first, const void* second)
+{
+    const pci_ids_device_t* a = (const pci_ids_device_t*)first;
+    const pci_ids_device_t* b = (const pci_ids_device_t*)second;
+
+    if(a->device_id != b->device_id)
+    {
+        return (a->device_id < b->device_id) ? -1 : 1;
+    }
+
+    return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+
+/* Function scan_pci_ids_vendor_section() walks through the section of given vendor in mapped pci.ids.
+ * If devices and subsystems arrays are provided entries are stored there, otherwise they are only counted.
  *
  * Note: pci.ids structure:
  * vendor_id[space][space]string[\n]
@@ -461,202 +622,671 @@ get_driver_version_from_os(driver_os_version_t* driver_version, char* version_fi
         8086 0001  Ethernet Controller XXV710 Intel(R) FPGA Programmable Acceleration Card N3000 for Networking
     1000  82542 Gigabit Ethernet Controller (Fiber)
         0e11 b0df  NC6132 Gigabit Ethernet Adapter (1000-SX)
-        0e11 b0e0  NC6133 Gigabit Ethernet Adapter (1000-LX)
-        0e11 b123  NC6134 Gigabit Ethernet Adapter (1000-LX)
         1014 0119  Netfinity Gigabit Ethernet SX Adapter
         8086 1000  PRO/1000 Gigabit Server Adapter
-    1001  82543GC Gigabit Ethernet Controller (Fiber)
-        0e11 004a  NC6136 Gigabit Server Adapter
-        1014 01ea  Netfinity Gigabit Ethernet SX Adapter
-        8086 1002  PRO/1000 F Server Adapter
-        8086 1003  PRO/1000 F Server Adapter
+ *
+ * Parameters:
+ * [in]     vendor_id   Vendor ID of the section
+ * [in,out] header      Index header - vendor name and number of entries are updated
+ * [out]    devices     Array for device entries or NULL
+ * [out]    subsystems  Array for subsystem entries or NULL
+ *
+ * Returns: None
+ */
+void
+scan_pci_ids_vendor_section(uint16_t vendor_id, pci_ids_index_header_t* header, pci_ids_device_t* devices, pci_ids_subsystem_t* subsystems)
+{
+    pci_ids_device_t* device      = NULL;
+    const char*       line        = NULL;
+    uint32_t          offset      = 0;
+    uint32_t          next_offset = 0;
+    uint32_t          line_length = 0;
+
+    /* offsets */
+    uint32_t          id_offset        = DDP_ID_BUFFER_SIZE - 1;    /* 4 chars of id */
+    uint32_t          vendor_name      = id_offset + 2;             /* vendor id (4) + 2 spaces */
+    uint32_t          device_name      = 1 + id_offset + 2;         /* tab (1) + device id (4) + 2 spaces */
+    uint32_t          subdevice_id     = 2 + id_offset + 1;         /* 2 tabs + subvendor id (4) + space (1) */
+    uint32_t          subsystem_name   = 2 + 2 * id_offset + 3;     /* 2 tabs, 8 chars, 3 spaces */
+
+    header->vendor_found         = FALSE;
+    header->number_of_devices    = 0;
+    header->number_of_subsystems = 0;
+
+    for(offset = 0; offset < pci_ids_size; offset = next_offset)
+    {
+        next_offset = get_pci_ids_line(offset, &line_length);
+        line        = pci_ids_data + offset;
+
+        if(header->vendor_found == FALSE)
+        {
+            /* vendor id is a top level key so the 1st char must be an alphanumeric */
+            if(line_length > 0 && isalnum((unsigned char)line[0]) != 0 && parse_pci_ids_id(line, line_length) == vendor_id)
+            {
+                header->vendor_found = TRUE;
+                get_pci_ids_name(offset, line_length, vendor_name, &header->vendor_name_offset, &header->vendor_name_length);
+            }
+            continue;
+        }
+
+        /* the next top level key ends the section - in a correct pci.ids file there is only a single unique vendor id section */
+        if(line_length > 0 && isalnum((unsigned char)line[0]) != 0)
+        {
+            break;
+        }
+
+        /* device id is preceded by a single tab, some lines will start with # acting as a comment - skip those */
+        if(line_length > 1 && line[0] == '\t' && isalnum((unsigned char)line[1]) != 0)
+        {
+            if(devices != NULL)
+            {
+                device = &devices[header->number_of_devices];
+                device->device_id            = parse_pci_ids_id(line + 1, line_length - 1);
+                device->reserved             = 0;
+                device->first_subsystem      = header->number_of_subsystems;
+                device->number_of_subsystems = 0;
+                device->order                = header->number_of_devices;
+                get_pci_ids_name(offset, line_length, device_name, &device->name_offset, &device->name_length);
+            }
+            header->number_of_devices++;
+            continue;
+        }
+
+        /* subvendor id is preceded by two tabs and starts with an alphanumeric */
+        if(line_length > 2 && line[0] == '\t' && line[1] == '\t' && isalnum((unsigned char)line[2]) != 0 &&
+           header->number_of_devices > 0)
+        {
+            if(subsystems != NULL)
+            {
+                subsystems[header->number_of_subsystems].subvendor_id = parse_pci_ids_id(line + 2, line_length - 2);
+                subsystems[header->number_of_subsystems].subdevice_id = line_length > subdevice_id ?
+                                                                        parse_pci_ids_id(line + subdevice_id, line_length - subdevice_id) : 0;
+                get_pci_ids_name(offset,
+                                 line_length,
+                                 subsystem_name,
+                                 &subsystems[header->number_of_subsystems].name_offset,
+                                 &subsystems[header->number_of_subsystems].name_length);
+                devices[header->number_of_devices - 1].number_of_subsystems++;
+            }
+            header->number_of_subsystems++;
+        }
+    }
+}
+
+/* Function build_pci_ids_index() parses the vendor section of mapped pci.ids and builds the index.
+ *
+ * Parameters:
+ * [in] vendor_id  Vendor ID of the indexed section
+ *
+ * Returns: DDP_SUCCESS or DDP_ALLOCATE_MEMORY_FAIL.
  */
 ddp_status_t
-get_branding_string_via_pci_ids(adapter_t* ddp_adapter, match_level* match_level)
+build_pci_ids_index(uint16_t vendor_id)
 {
-    FILE*        file_handle          = NULL;
-    const char*  path_to_pci_ids      = "/usr/share/hwdata/pci.ids";
-    ddp_status_t ddp_status           = DDP_SUCCESS;
-    uint32_t     vendor_id_string_len = 0;
-    uint32_t     candidate_id         = 0;
-    uint32_t     base_hex             = 16;
-    bool         stop_search          = FALSE;
+    ddp_status_t status = DDP_SUCCESS;
 
-    /* buffers */
-    char         branding_string[DDP_MAX_BRANDING_SIZE];
-    char         line[DDP_MAX_BUFFER_SIZE];
-    char         id_candidate[DDP_MAX_BUFFER_SIZE];
+    do
+    {
+        MEMINIT(&pci_ids_header);
+        pci_ids_header.magic           = DDP_PCI_IDS_INDEX_MAGIC;
+        pci_ids_header.version         = DDP_PCI_IDS_INDEX_VERSION;
+        pci_ids_header.file_device     = (uint64_t)pci_ids_stat.st_dev;
+        pci_ids_header.file_inode      = (uint64_t)pci_ids_stat.st_ino;
+        pci_ids_header.file_size       = (uint64_t)pci_ids_stat.st_size;
+        pci_ids_header.file_mtime_sec  = (int64_t)pci_ids_stat.st_mtim.tv_sec;
+        pci_ids_header.file_mtime_nsec = (int64_t)pci_ids_stat.st_mtim.tv_nsec;
+        pci_ids_header.vendor_id       = vendor_id;
+
+        /* 1st pass counts entries, 2nd one fills the index */
+        scan_pci_ids_vendor_section(vendor_id, &pci_ids_header, NULL, NULL);
+
+        if(pci_ids_header.number_of_devices > 0)
+        {
+            pci_ids_devices = malloc_sec(sizeof(pci_ids_device_t) * pci_ids_header.number_of_devices);
+            if(pci_ids_devices == NULL)
+            {
+                status = DDP_ALLOCATE_MEMORY_FAIL;
+                break;
+            }
+        }
+        if(pci_ids_header.number_of_subsystems > 0)
+        {
+            pci_ids_subsystems = malloc_sec(sizeof(pci_ids_subsystem_t) * pci_ids_header.number_of_subsystems);
+            if(pci_ids_subsystems == NULL)
+            {
+                status = DDP_ALLOCATE_MEMORY_FAIL;
+                break;
+            }
+        }
 
-    /* offsets */
-    uint32_t     space_offset            = 1; /* 1 char for 1 space */
-    uint32_t     double_space_offset     = 2; /* 2 chars for 2 spaces */
-    uint32_t     id_offset               = 4; /* 4 chars of vendor id */
-    uint32_t     id_spaces_offset        = id_offset + double_space_offset; /* offset by vendor id (4) + 2 spaces */
-    uint32_t     sub_id_offsets          = (2*id_offset) + (3*space_offset); /* 8 chars for sub ids + 3 spaces */
+        scan_pci_ids_vendor_section(vendor_id, &pci_ids_header, pci_ids_devices, pci_ids_subsystems);
 
-    /* initialize buffers */
-    memset(branding_string, '\0',DDP_MAX_BRANDING_SIZE);
-    memset(line, '\0', DDP_MAX_BUFFER_SIZE);
-    memset(id_candidate, '\0', DDP_MAX_BUFFER_SIZE);
+        qsort(pci_ids_devices, pci_ids_header.number_of_devices, sizeof(pci_ids_device_t), compare_pci_ids_device);
+    } while(0);
+
+    return status;
+}
+
+/* Function read_pci_ids_index_data() reads exactly requested number of bytes from the index file */
+ddp_status_t
+read_pci_ids_index_data(int file_descriptor, void* buffer, size_t size)
+{
+    ssize_t result = 0;
+    size_t  done   = 0;
+
+    while(done < size)
+    {
+        result = read(file_descriptor, (char*)buffer + done, size - done);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            return DDP_FILE_ACCESS_ERROR;
+        }
+        done += (size_t)result;
+    }
+
+    return DDP_SUCCESS;
+}
+
+/* Function write_pci_ids_index_data() writes exactly requested number of bytes to the index file */
+ddp_status_t
+write_pci_ids_index_data(int file_descriptor, const void* buffer, size_t size)
+{
+    ssize_t result = 0;
+    size_t  done   = 0;
+
+    while(done < size)
+    {
+        result = write(file_descriptor, (const char*)buffer + done, size - done);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            return DDP_FILE_ACCESS_ERROR;
+        }
+        done += (size_t)result;
+    }
+
+    return DDP_SUCCESS;
+}
+
+/* Function load_pci_ids_index() loads the index of given vendor from the on-disk cache. The cache is used
+ * only if it was generated for the currently installed pci.ids file (same inode, size and mtime).
+ *
+ * Parameters:
+ * [in] vendor_id  Vendor ID of the indexed section
+ *
+ * Returns: DDP_SUCCESS if the index was loaded or error code otherwise.
+ */
+ddp_status_t
+load_pci_ids_index(uint16_t vendor_id)
+{
+    pci_ids_index_header_t header;
+    struct stat            index_stat;
+    ddp_status_t           status          = DDP_FILE_ACCESS_ERROR;
+    uint32_t               i               = 0;
+    int                    file_descriptor = -1;
+
+    MEMINIT(&header);
+
+    do
+    {
+        file_descriptor = open(PATH_TO_PCI_IDS_INDEX, O_RDONLY | O_CLOEXEC);
+        if(file_descriptor < 0)
+        {
+            break;
+        }
+
+        if(read_pci_ids_index_data(file_descriptor, &header, sizeof(header)) != DDP_SUCCESS ||
+           fstat(file_descriptor, &index_stat) != 0)
+        {
+            break;
+        }
+
+        if(header.magic           != DDP_PCI_IDS_INDEX_MAGIC                ||
+           header.version         != DDP_PCI_IDS_INDEX_VERSION              ||
+           header.file_device     != (uint64_t)pci_ids_stat.st_dev          ||
+           header.file_inode      != (uint64_t)pci_ids_stat.st_ino          ||
+           header.file_size       != (uint64_t)pci_ids_stat.st_size         ||
+           header.file_mtime_sec  != (int64_t)pci_ids_stat.st_mtim.tv_sec   ||
+           header.file_mtime_nsec != (int64_t)pci_ids_stat.st_mtim.tv_nsec  ||
+           header.vendor_id       != vendor_id                              ||
+           header.number_of_devices > pci_ids_size                          ||
+           header.number_of_subsystems > pci_ids_size                       ||
+           (uint64_t)index_stat.st_size != sizeof(header) +
+                                           (uint64_t)header.number_of_devices * sizeof(pci_ids_device_t) +
+                                           (uint64_t)header.number_of_subsystems * sizeof(pci_ids_subsystem_t))
+        {
+            debug_ddp_print("pci.ids index cache is outdated\n");
+            break;
+        }
+
+        if(header.number_of_devices > 0)
+        {
+            pci_ids_devices = malloc_sec(sizeof(pci_ids_device_t) * header.number_of_devices);
+            if(pci_ids_devices == NULL ||
+               read_pci_ids_index_data(file_descriptor, pci_ids_devices, sizeof(pci_ids_device_t) * header.number_of_devices) != DDP_SUCCESS)
+            {
+                break;
+            }
+        }
+        if(header.number_of_subsystems > 0)
+        {
+            pci_ids_subsystems = malloc_sec(sizeof(pci_ids_subsystem_t) * header.number_of_subsystems);
+            if(pci_ids_subsystems == NULL ||
+               read_pci_ids_index_data(file_descriptor, pci_ids_subsystems, sizeof(pci_ids_subsystem_t) * header.number_of_subsystems) != DDP_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        /* names are referenced by offsets - all of them have to be placed inside pci.ids */
+        status = DDP_SUCCESS;
+        if((uint64_t)header.vendor_name_offset + header.vendor_name_length > pci_ids_size)
+        {
+            status = DDP_FILE_ACCESS_ERROR;
+        }
+        for(i = 0; i < header.number_of_devices && status == DDP_SUCCESS; i++)
+        {
+            if((uint64_t)pci_ids_devices[i].name_offset + pci_ids_devices[i].name_length > pci_ids_size ||
+               (uint64_t)pci_ids_devices[i].first_subsystem + pci_ids_devices[i].number_of_subsystems > header.number_of_subsystems)
+            {
+                status = DDP_FILE_ACCESS_ERROR;
+            }
+        }
+        for(i = 0; i < header.number_of_subsystems && status == DDP_SUCCESS; i++)
+        {
+            if((uint64_t)pci_ids_subsystems[i].name_offset + pci_ids_subsystems[i].name_length > pci_ids_size)
+            {
+                status = DDP_FILE_ACCESS_ERROR;
+            }
+        }
+        if(status != DDP_SUCCESS)
+        {
+            debug_ddp_print("pci.ids index cache is corrupted\n");
+            break;
+        }
+
+        pci_ids_header = header;
+    } while(0);
+
+    if(file_descriptor >= 0)
+    {
+        close(file_descriptor);
+    }
+
+    if(status != DDP_SUCCESS)
+    {
+        free_memory(pci_ids_devices);
+        free_memory(pci_ids_subsystems);
+        pci_ids_devices    = NULL;
+        pci_ids_subsystems = NULL;
+    }
+
+    return status;
+}
+
+/* Function save_pci_ids_index() stores the index in the on-disk cache. The cache is optional - it is written
+ * only if the cache directory exists, errors are ignored.
+ */
+void
+save_pci_ids_index(void)
+{
+    ddp_status_t status                        = DDP_SUCCESS;
+    int          file_descriptor               = -1;
+    char         temp_file_name[MAX_FILE_NAME] = PATH_TO_PCI_IDS_INDEX_TEMP;
+
+    do
+    {
+        /* unique temporary file is created exclusively, so concurrent runs never share it and a
+         * planted symlink is never followed */
+        file_descriptor = mkstemp(temp_file_name);
+        if(file_descriptor < 0)
+        {
+            break;
+        }
+        if(fchmod(file_descriptor, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0)
+        {
+            status = DDP_FILE_ACCESS_ERROR;
+        }
+
+        if(status == DDP_SUCCESS)
+        {
+            status = write_pci_ids_index_data(file_descriptor, &pci_ids_header, sizeof(pci_ids_header));
+        }
+        if(status == DDP_SUCCESS && pci_ids_header.number_of_devices > 0)
+        {
+            status = write_pci_ids_index_data(file_descriptor, pci_ids_devices, sizeof(pci_ids_device_t) * pci_ids_header.number_of_devices);
+        }
+        if(status == DDP_SUCCESS && pci_ids_header.number_of_subsystems > 0)
+        {
+            status = write_pci_ids_index_data(file_descriptor, pci_ids_subsystems, sizeof(pci_ids_subsystem_t) * pci_ids_header.number_of_subsystems);
+        }
+        if(close(file_descriptor) != 0)
+        {
+            status = DDP_FILE_ACCESS_ERROR;
+        }
+
+        /* replace the cache atomically so concurrent runs never see a partial file */
+        if(status != DDP_SUCCESS || rename(temp_file_name, PATH_TO_PCI_IDS_INDEX) != 0)
+        {
+            debug_ddp_print("Cannot store pci.ids index cache\n");
+            unlink(temp_file_name);
+        }
+    } while(0);
+}
+
+/* Function get_pci_ids_index() makes sure the index of given vendor section is available. The index is
+ * loaded from the on-disk cache if possible, otherwise it is built from mapped pci.ids.
+ *
+ * Parameters:
+ * [in] vendor_id  Vendor ID of the indexed section
+ *
+ * Returns: DDP_SUCCESS or error code.
+ */
+ddp_status_t
+get_pci_ids_index(uint16_t vendor_id)
+{
+    ddp_status_t status = DDP_SUCCESS;
+
+    do
+    {
+        status = map_pci_ids();
+        if(status != DDP_SUCCESS)
+        {
+            break;
+        }
+
+        if(pci_ids_indexed == TRUE && pci_ids_header.vendor_id == vendor_id)
+        {
+            break;
+        }
+
+        free_memory(pci_ids_devices);
+        free_memory(pci_ids_subsystems);
+        pci_ids_devices    = NULL;
+        pci_ids_subsystems = NULL;
+        pci_ids_indexed    = FALSE;
+
+        if(load_pci_ids_index(vendor_id) == DDP_SUCCESS)
+        {
+            debug_ddp_print("pci.ids index loaded from %s\n", PATH_TO_PCI_IDS_INDEX);
+            pci_ids_indexed = TRUE;
+            break;
+        }
+
+        status = build_pci_ids_index(vendor_id);
+        if(status != DDP_SUCCESS)
+        {
+            free_memory(pci_ids_devices);
+            free_memory(pci_ids_subsystems);
+            pci_ids_devices    = NULL;
+            pci_ids_subsystems = NULL;
+            break;
+        }
+        debug_ddp_print("pci.ids index built: %d devices, %d subsystems\n",
+                        pci_ids_header.number_of_devices,
+                        pci_ids_header.number_of_subsystems);
+        pci_ids_indexed = TRUE;
+
+        save_pci_ids_index();
+    } while(0);
+
+    return status;
+}
+
+/* Function find_pci_ids_device() returns the first indexed device with given device ID or NULL */
+pci_ids_device_t*
+find_pci_ids_device(uint16_t device_id)
+{
+    uint32_t low    = 0;
+    uint32_t high   = pci_ids_header.number_of_devices;
+    uint32_t middle = 0;
+
+    while(low < high)
+    {
+        middle = low + (high - low) / 2;
+        if(pci_ids_devices[middle].device_id < device_id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if(low < pci_ids_header.number_of_devices && pci_ids_devices[low].device_id == device_id)
+    {
+        return &pci_ids_devices[low];
+    }
+
+    return NULL;
+}
+
+/* Function find_branding_string_in_pci_ids() looks up 2-PartId/4-PartId of the adapter in pci.ids index
+ *
+ * Parameters:
+ * [in]  ddp_adapter      ddp adapter struct
+ * [out] match_level      4 if 4-PartId match, 2 if 2-PartId match, 1 if vendor match, 0 if no match
+ * [out] branding_string  Buffer of DDP_MAX_BRANDING_SIZE for the branding string
+ *
+ * Returns: None
+ */
+void
+find_branding_string_in_pci_ids(adapter_t* ddp_adapter, match_level* match_level, char* branding_string)
+{
+    pci_ids_device_t*    device    = NULL;
+    pci_ids_subsystem_t* subsystem = NULL;
+    uint32_t             i         = 0;
 
     *match_level = no_match;
 
     do
     {
-        file_handle = fopen(path_to_pci_ids, "r");
-        if(file_handle == NULL)
+        if(pci_ids_header.vendor_found == FALSE)
         {
-            ddp_status = DDP_FILE_ACCESS_ERROR;
             break;
         }
+        *match_level = vendor_id_match;
 
-        while(fgets(line, DDP_MAX_BUFFER_SIZE, file_handle))
+        device = find_pci_ids_device(ddp_adapter->device_id);
+        if(device == NULL)
         {
-            if(stop_search == TRUE)
+            break;
+        }
+        *match_level = device_id_match;
+
+        for(i = 0; i < device->number_of_subsystems; i++)
+        {
+            subsystem = &pci_ids_subsystems[device->first_subsystem + i];
+            if(subsystem->subvendor_id == ddp_adapter->subvendor_id &&
+               subsystem->subdevice_id == ddp_adapter->subdevice_id)
             {
+                *match_level = four_part_id_match;
                 break;
             }
+        }
+
+        /* vendor id string is concatenated with subvendor/subdevice id string or with device id string */
+        snprintf(branding_string,
+                 DDP_MAX_BRANDING_SIZE,
+                 "%.*s %.*s",
+                 (int)pci_ids_header.vendor_name_length,
+                 pci_ids_data + pci_ids_header.vendor_name_offset,
+                 (int)(*match_level == four_part_id_match ? subsystem->name_length : device->name_length),
+                 pci_ids_data + (*match_level == four_part_id_match ? subsystem->name_offset : device->name_offset));
+    } while(0);
+}
 
-            switch(*match_level)
+/* Function find_pci_ids_memo() returns memoized pci.ids lookup result for given 4-part ID or NULL.
+ * Results are sorted by key, the position where the result belongs is returned in 'position'.
+ */
+pci_ids_memo_t*
+find_pci_ids_memo(uint64_t key, uint32_t* position)
+{
+    uint32_t first  = 0;
+    uint32_t last   = pci_ids_memo_count;
+    uint32_t middle = 0;
+
+    while(first < last)
+    {
+        middle = first + (last - first) / 2;
+        if(pci_ids_memo[middle].key == key)
+        {
+            *position = middle;
+            return &pci_ids_memo[middle];
+        }
+        if(pci_ids_memo[middle].key < key)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+    *position = first;
+
+    return NULL;
+}
+
+/* Function add_pci_ids_memo() memoizes pci.ids lookup result. Failures are not fatal - the lookup will be repeated. */
+void
+add_pci_ids_memo(uint64_t key, match_level match_level, const char* branding_string)
+{
+    pci_ids_memo_t  memo;
+    pci_ids_memo_t* entries  = NULL;
+    uint32_t        capacity = 0;
+    uint32_t        position = 0;
+
+    MEMINIT(&memo);
+
+    do
+    {
+        if(find_pci_ids_memo(key, &position) != NULL)
+        {
+            break;
+        }
+
+        memo.key         = key;
+        memo.match_level = match_level;
+        if(match_level == device_id_match || match_level == four_part_id_match)
+        {
+            memo.branding_string = arena_malloc(strlen(branding_string) + 1);
+            if(memo.branding_string == NULL)
             {
-                /* looking for vendor id match */
-                case no_match:
-                {
-                    /* vendor id is a top level key so the 1st char must be an alphanumeric */
-                    if(isalnum(line[0]) == 0)
-                    {
-                        continue; /* read next line */
-                    }
-                    else
-                    {
-                        /* collect candidate vendor id */
-                        strcpy_sec(id_candidate, DDP_MAX_BUFFER_SIZE, line, id_offset);
-                        candidate_id = (uint32_t)(strtol(id_candidate, NULL /* end pointer */, base_hex));
-
-                        /* compare candidate vendor id with adapter vendor id */
-                        if(candidate_id == ddp_adapter->vendor_id)
-                        {
-                            /* keep this value in case subvendor/subdevice id match */
-                            vendor_id_string_len = strlen(line + id_spaces_offset);
-                            /* initialize branding string */
-                            strcat_sec(branding_string,
-                                       DDP_MAX_BRANDING_SIZE,
-                                       line + id_spaces_offset,
-                                       vendor_id_string_len);
-                            /* vendor id found */
-                            *match_level = vendor_id_match;
-                        }
-                    }
-                    break;
-                }
-
-                /* looking for device id match */
-                case vendor_id_match:
-                {
-                    /* if the 1st char of the line is an alphanumeric - we have reached a new vendor id section
-                     * the search is over - in a correct pci.ids file there is only a single unique vendor id section */
-                    if(isalnum(line[0]) != 0)
-                    {
-                        stop_search = TRUE;
-                        continue; /* jump to next while condition check to break there */
-                    }
-                    /* device id is preceded by a single tab */
-                    if(line[0] != '\t' || isalnum(line[1]) == 0)
-                    {
-                        /* some lines will start with # acting as a comment - skip those */
-                        continue;
-                    }
-                    else
-                    {
-                        /* collect candidate device id */
-                        strcpy_sec(id_candidate,
-                                   DDP_MAX_BUFFER_SIZE,
-                                   line + *match_level, /* offset of 1 tab */
-                                   id_offset /* 4 chars of device id */);
-                        candidate_id = (uint32_t)(strtol(id_candidate, NULL /* end pointer */, base_hex));
-
-                        /* compare candidate device id with adapter device id */
-                        if(candidate_id == ddp_adapter->device_id)
-                        {
-                            /* extend branding string */
-                            strcat_sec(branding_string,
-                                       DDP_MAX_BRANDING_SIZE,
-                                       line + *match_level + id_spaces_offset /* offset by tab (1) + device id (4) + 2 spaces */,
-                                       strlen(line + *match_level + id_spaces_offset) /* offset by tab (1) + device id (4) + 2 spaces */);
-                            /* device id found */
-                            *match_level = device_id_match;
-                        }
-                    }
-                    break;
-                }
-
-                /* looking for subvendor and subdevice id match */
-                case device_id_match:
-                {
-                    /* if the 1st char of the line is an alphanumeric - we have reached a new vendor id section
-                     * the search is over - in a correct pci.ids file there is only a single unique vendor id section */
-                    if(isalnum(line[0]) != 0)
-                    {
-                        stop_search = TRUE;
-                        continue; /* jump to next while condition check to break there */
-                    }
-                    /* if the 1st char is a tab, but the 2nd is an alphanumeric - we're in a new device id section
-                     * and the search is over */
-                    if((line[0] == '\t') && isalnum(line[1]) != 0)
-                    {
-                        stop_search = TRUE;
-                        continue; /* jump to next while condition check to break there */
-                    }
-                    /* subvendor id is preceded by two tabs and starts with an alphanumeric*/
-                    if(line[0] != '\t' || line[1] != '\t' || isalnum(line[2]) == 0)
-                    {
-                        /* some lines will start with # acting as a comment - skip those */
-                        continue;
-                    }
-                    else
-                    {
-                        /* collect candidate subvendor id */
-                        strcpy_sec(id_candidate,
-                                   DDP_MAX_BUFFER_SIZE,
-                                   line + *match_level, /* offset of 2 tabs */
-                                   id_offset /* 4 chars of subvendor id */);
-                        candidate_id = (uint32_t)(strtol(id_candidate, NULL /* end pointer */, base_hex));
-
-                        /* compare candidate subvendor id with adapter subvendor id */
-                        if(candidate_id == ddp_adapter->subvendor_id)
-                        {
-                            /* collect candidate subdevice id */
-                            strcpy_sec(id_candidate,
-                                       DDP_MAX_BUFFER_SIZE,
-                                       line + *match_level + id_offset + space_offset, /* offset of 2 tabs + subvendor id (4) + space (1) */
-                                       id_offset /* 4 chars of subdevice id */);
-                            candidate_id = (uint32_t)(strtol(id_candidate, NULL /* end pointer */, base_hex));
-                            /* compare candidate subdevice id with adapter subdevice id */
-                            if(candidate_id == ddp_adapter->subdevice_id)
-                            {
-                                /* 4-part id match -> concat vendor id string with subvendor/subdevice id string
-                                 * writing over the 2-part id match string */
-                                extended_strcpy_sec(branding_string,
-                                                    vendor_id_string_len,
-                                                    DDP_MAX_BRANDING_SIZE,
-                                                    line + *match_level + sub_id_offsets, /* 2 tabs, 8 chars, 3 spaces */
-                                                    strlen(line + *match_level + sub_id_offsets) /* 2 tabs, 8 chars, 3 spaces*/);
-                                *match_level = four_part_id_match;
-                                stop_search = TRUE;
-                            }
-                        }
-                    }
-                    break;
-                }
-                case four_part_id_match:
-                {
-                    break;
-                }
+                break;
+            }
+            strcpy_sec(memo.branding_string, strlen(branding_string) + 1, branding_string, strlen(branding_string));
+        }
+
+        /* the array grows geometrically and stays sorted by key */
+        if(pci_ids_memo_count == pci_ids_memo_capacity)
+        {
+            capacity = (pci_ids_memo_capacity == 0) ? PCI_IDS_MEMO_INITIAL_SIZE : pci_ids_memo_capacity * 2;
+            entries  = realloc(pci_ids_memo, sizeof(pci_ids_memo_t) * capacity);
+            if(entries == NULL)
+            {
+                break;
+            }
+            pci_ids_memo          = entries;
+            pci_ids_memo_capacity = capacity;
+        }
+
+        memmove(&pci_ids_memo[position + 1],
+                &pci_ids_memo[position],
+                sizeof(pci_ids_memo_t) * (pci_ids_memo_count - position));
+        pci_ids_memo[position] = memo;
+        pci_ids_memo_count++;
+    } while(0);
+}
+
+/* Function release_pci_ids_index() releases mapped pci.ids, its index and memoized lookup results */
+void
+release_pci_ids_index(void)
+{
+    /* branding strings of memoized results are allocated from the arena */
+    free_memory(pci_ids_memo);
+    pci_ids_memo          = NULL;
+    pci_ids_memo_count    = 0;
+    pci_ids_memo_capacity = 0;
+
+    free_memory(pci_ids_devices);
+    free_memory(pci_ids_subsystems);
+    pci_ids_devices    = NULL;
+    pci_ids_subsystems = NULL;
+    pci_ids_indexed    = FALSE;
+
+    if(pci_ids_data != NULL)
+    {
+        munmap(pci_ids_data, pci_ids_size);
+    }
+    pci_ids_data   = NULL;
+    pci_ids_size   = 0;
+    pci_ids_mapped = FALSE;
+}
+
+/* Functions looks up 2-PartId/4-PartId in pci.ids and collects a branding string for current adapter.
+ * pci.ids is mapped and the vendor section is indexed once per run, results are memoized per 4-PartId.
+ *
+ * Parameters:
+ * [in, out] adapter     ddp adapter struct - branding string written to adapter->branding_string
+ * [out]    match_level  4 if 4-PartId match, 2 if 2-PartId match, 0 if no match
+ *
+ * Returns: success if no issues or error code otherwise
+ */
+ddp_status_t
+get_branding_string_via_pci_ids(adapter_t* ddp_adapter, match_level* match_level)
+{
+    pci_ids_memo_t* memo       = NULL;
+    ddp_status_t    ddp_status = DDP_SUCCESS;
+    uint32_t        position   = 0;
+    uint64_t        key        = DDP_4_PART_ID_KEY(ddp_adapter->vendor_id,
+                                                   ddp_adapter->device_id,
+                                                   ddp_adapter->subvendor_id,
+                                                   ddp_adapter->subdevice_id);
+
+    /* buffers */
+    char            branding_string[DDP_MAX_BRANDING_SIZE];
+
+    /* initialize buffers */
+    memset(branding_string, '\0',DDP_MAX_BRANDING_SIZE);
+
+    *match_level = no_match;
+
+    do
+    {
+        memo = find_pci_ids_memo(key, &position);
+        if(memo != NULL)
+        {
+            *match_level = memo->match_level;
+            if(memo->branding_string != NULL)
+            {
+                strcpy_sec(branding_string,
+                           DDP_MAX_BRANDING_SIZE,
+                           memo->branding_string,
+                           strlen(memo->branding_string));
+            }
+        }
+        else
+        {
+            ddp_status = get_pci_ids_index(ddp_adapter->vendor_id);
+            if(ddp_status != DDP_SUCCESS)
+            {
+                break;
             }
+            find_branding_string_in_pci_ids(ddp_adapter, match_level, branding_string);
+            add_pci_ids_memo(key, *match_level, branding_string);
         }
 
         /* set branding string in adapter structure */
-        ddp_adapter->branding_string = (char*)(malloc(DDP_MAX_BRANDING_SIZE * sizeof(char)));
+        ddp_adapter->branding_string = (char*)(malloc_sec(DDP_MAX_BRANDING_SIZE * sizeof(char)));
         if(ddp_adapter->branding_string == NULL)
         {
             ddp_status = DDP_ALLOCATE_MEMORY_FAIL;
@@ -665,9 +1295,6 @@ get_branding_string_via_pci_ids(adapter_t* ddp_adapter, match_level* match_level
         ddp_adapter->branding_string_allocated = TRUE;
         if(*match_level == device_id_match || *match_level == four_part_id_match)
         {
-            /* process branding string from pci.ids */
-            replace_character(branding_string, '\n', ' ' ); /* remove new line characters */
-            branding_string[strlen(branding_string) - 1] = '\0'; /* remove trailing white space */
             strcpy_sec(ddp_adapter->branding_string,
                        DDP_MAX_BRANDING_SIZE,
                        branding_string,
@@ -703,11 +1330,6 @@ get_branding_string_via_pci_ids(adapter_t* ddp_adapter, match_level* match_level
         }
     } while(0);
 
-    if(file_handle != NULL)
-    {
-        fclose(file_handle);
-    }
-
     return ddp_status;
 }
 
@@ -424,7 +424,14 @@ print_xml_adapter(adapter_t* adapter, FILE* stream)
             adapter->location.function,
             adapter->connection_name,
             adapter->branding_string);
-    if(adapter->profile_info.section_size > 0)
+    if(adapter->selector_status != DDP_SUCCESS)
+    {
+        fprintf(stream,
+                "\t\t<Status result=\"failed\" error=\"%i\">%s</Status>\n",
+                adapter->selector_status,
+                get_error_message(adapter->selector_status));
+    }
+    else if(adapter->profile_info.section_size > 0)
     {
         print_xml_profile(adapter, stream);
     }
@@ -521,7 +528,8 @@ generate_json(list_t* adapter_list, ddp_status_value_t tool_status, char* file_n
                 fprintf(json_file, "\t\t{\n");
             }
 
-            if(adapter->device_id == 0) /* If deviceid is equal 0, it means that tool is working with a file.*/
+            if(adapter->device_id == 0 && /* If deviceid is equal 0, it means that tool is working with a file.*/
+               adapter->selector_status == DDP_SUCCESS)
             {
                 print_json_file(adapter, json_file, &(adapter_list->number_of_nodes));
             }
@@ -621,6 +629,17 @@ print_json_adapter(adapter_t* adapter, FILE* stream, uint32_t* number_of_nodes)
     fprintf(stream, "%s\"name\": \"%s\",\n", indentation_string, adapter->connection_name);
     fprintf(stream, "%s\"display\": \"%s\"", indentation_string, adapter->branding_string);
 
+    /* Selector which was not resolved in batch mode */
+    if(adapter->selector_status != DDP_SUCCESS)
+    {
+        fprintf(stream, ",\n%s\"error\": \"%i\",\n", indentation_string, adapter->selector_status);
+        fprintf(stream,
+                "%s\"message\": \"%s\"\n",
+                indentation_string,
+                get_error_message(adapter->selector_status));
+        return;
+    }
+
     /* Skip last comma if there will be no DDP profile section */
     adapter->profile_info.section_size > 0 ? fprintf(stream, ",\n") : fprintf(stream, "\n");
 